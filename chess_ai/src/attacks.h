@@ -0,0 +1,103 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// Таблицы атак и геометрии доски, считаются при компиляции (без инициализации
+// при старте). Клетка 0..63 (a1 = 0), в битборде бит s — клетка s.
+namespace Attacks {
+    using Table = std::array<uint64_t, 64>;
+    using Table2 = std::array<Table, 64>;
+
+    namespace detail {
+        // противоположные направления — соседние: d и d ^ 1
+        constexpr int DIRS[8][2] = { {1,0},{-1,0},{0,1},{0,-1},{1,1},{-1,-1},{-1,1},{1,-1} };
+
+        constexpr bool onBoard(int f, int r) { return f >= 0 && f < 8 && r >= 0 && r < 8; }
+
+        template <int N>
+        constexpr Table leaper(const int (&d)[N][2]) {
+            Table t{};
+            for (int s = 0; s < 64; ++s)
+                for (int k = 0; k < N; ++k) {
+                    int f = (s & 7) + d[k][0], r = (s >> 3) + d[k][1];
+                    if (onBoard(f, r)) t[s] |= 1ULL << (r * 8 + f);
+                }
+            return t;
+        }
+
+        // луч от s в направлении d, без самой s
+        constexpr uint64_t ray(int s, int d) {
+            uint64_t bb = 0;
+            int f = (s & 7) + DIRS[d][0], r = (s >> 3) + DIRS[d][1];
+            for (; onBoard(f, r); f += DIRS[d][0], r += DIRS[d][1]) bb |= 1ULL << (r * 8 + f);
+            return bb;
+        }
+
+        constexpr int KNIGHT_D[8][2] = { {1,2},{2,1},{2,-1},{1,-2},{-1,-2},{-2,-1},{-2,1},{-1,2} };
+        constexpr int PAWN_D[2][2][2] = { { {-1,1},{1,1} }, { {-1,-1},{1,-1} } };
+    }
+
+    inline constexpr Table KNIGHT = detail::leaper(detail::KNIGHT_D);
+    inline constexpr Table KING = detail::leaper(detail::DIRS);
+
+    // PAWN[c][s] — клетки, которые бьёт пешка цвета c (0 — белые) с клетки s.
+    // Кто бьёт s пешкой цвета c: PAWN[c ^ 1][s].
+    inline constexpr std::array<Table, 2> PAWN = { detail::leaper(detail::PAWN_D[0]),
+                                                   detail::leaper(detail::PAWN_D[1]) };
+
+    // LINE[a][b] — вся линия (вертикаль, горизонталь или диагональ) через a и b,
+    // включая их; BETWEEN[a][b] — клетки строго между. Не на одной линии — 0.
+    inline constexpr Table2 LINE = [] {
+        Table2 t{};
+        for (int a = 0; a < 64; ++a)
+            for (int d = 0; d < 8; d += 2) {            // по оси: d и обратное d ^ 1
+                uint64_t line = (1ULL << a) | detail::ray(a, d) | detail::ray(a, d ^ 1);
+                for (uint64_t bb = line & ~(1ULL << a); bb; bb &= bb - 1)
+                    t[a][std::countr_zero(bb)] = line;
+            }
+        return t;
+    }();
+
+    inline constexpr Table2 BETWEEN = [] {
+        Table2 t{};
+        for (int a = 0; a < 64; ++a)
+            for (int d = 0; d < 8; ++d) {
+                uint64_t passed = 0;
+                int f = (a & 7) + detail::DIRS[d][0], r = (a >> 3) + detail::DIRS[d][1];
+                for (; detail::onBoard(f, r); f += detail::DIRS[d][0], r += detail::DIRS[d][1]) {
+                    t[a][r * 8 + f] = passed;
+                    passed |= 1ULL << (r * 8 + f);
+                }
+            }
+        return t;
+    }();
+
+    // ходы слона и ладьи на пустой доске: кандидаты, блокеры — через BETWEEN
+    inline constexpr Table BISHOP_RAYS = [] {
+        Table t{};
+        for (int s = 0; s < 64; ++s)
+            for (int d = 4; d < 8; ++d) t[s] |= detail::ray(s, d);
+        return t;
+    }();
+
+    inline constexpr Table ROOK_RAYS = [] {
+        Table t{};
+        for (int s = 0; s < 64; ++s)
+            for (int d = 0; d < 4; ++d) t[s] |= detail::ray(s, d);
+        return t;
+    }();
+
+    // расстояние для короля (в ходах)
+    inline constexpr std::array<std::array<uint8_t, 64>, 64> DISTANCE = [] {
+        std::array<std::array<uint8_t, 64>, 64> t{};
+        for (int a = 0; a < 64; ++a)
+            for (int b = 0; b < 64; ++b) {
+                int df = (a & 7) - (b & 7), dr = (a >> 3) - (b >> 3);
+                if (df < 0) df = -df;
+                if (dr < 0) dr = -dr;
+                t[a][b] = (uint8_t)(df > dr ? df : dr);
+            }
+        return t;
+    }();
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+namespace Bench {
+    // Фиксированный набор позиций, каждая с чистого состояния (newGame).
+    // nodes > 0 — лимит узлов на позицию вместо глубины: итог не зависит
+    // от загрузки машины. По глубине сумма узлов служит сигнатурой сборки.
+    struct Options {
+        int depth = 8;
+        uint64_t nodes = 0;
+        int evalCacheMB = -1;           // -1 — размер по умолчанию, 0 — без кэша
+    };
+
+    uint64_t run(const Options& opt);   // сумма узлов по всем позициям
+}
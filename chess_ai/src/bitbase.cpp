@@ -0,0 +1,207 @@
+#include "bitbase.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+
+using namespace std;
+
+// заголовок файла: "CBB1", число фигур, 3 байта резерва, число позиций (LE)
+static const char MAGIC[4] = { 'C', 'B', 'B', '1' };
+static const size_t HEADER_SIZE = 16;
+
+struct Table {
+    Bitbase::Material mat;
+    const uint8_t* data = nullptr;
+    MappedFile file;
+};
+
+static vector<unique_ptr<Table>> tables;
+static unordered_map<uint32_t, Table*> byKey;
+static int maxLoaded = 0;
+
+static inline Piece whiteKind(Piece p) {
+    int v = (int)p;
+    return (v >= (int)Piece::BP) ? (Piece)(v - 6) : p;
+}
+
+static char pieceLetter(Piece p) {
+    switch (whiteKind(p)) {
+        case Piece::WQ: return 'Q';
+        case Piece::WR: return 'R';
+        case Piece::WB: return 'B';
+        case Piece::WN: return 'N';
+        case Piece::WP: return 'P';
+        default: return '?';
+    }
+}
+
+// списки по убыванию: больше фигур сильнее, затем по старшей фигуре
+static bool stronger(const Piece* a, int na, const Piece* b, int nb) {
+    if (na != nb) return na > nb;
+    return lexicographical_compare(b, b + nb, a, a + na);
+}
+
+static uint32_t materialKey(const Piece* white, int nw, const Piece* black, int nb) {
+    uint32_t k = 0;
+    for (int i = 0; i < nw; ++i) k = k * 8 + (uint32_t)white[i];
+    k = k * 8 + 7;                                     // разделитель
+    for (int i = 0; i < nb; ++i) k = k * 8 + (uint32_t)black[i];
+    return k;
+}
+
+namespace Bitbase {
+
+string Material::name() const {
+    string s = "K";
+    for (Piece p : white) s += pieceLetter(p);
+    s += "vK";
+    for (Piece p : black) s += pieceLetter(p);
+    return s;
+}
+
+int Material::pawns() const {
+    return (int)count_if(white.begin(), white.end(), [](Piece p) { return p == Piece::WP; })
+         + (int)count_if(black.begin(), black.end(), [](Piece p) { return p == Piece::WP; });
+}
+
+vector<Material> allMaterials() {
+    static const Piece kinds[5] = { Piece::WQ, Piece::WR, Piece::WB, Piece::WN, Piece::WP };
+
+    vector<Material> out;
+    for (int i = 0; i < 5; ++i)
+        out.push_back({ { kinds[i] }, {} });
+
+    for (int i = 0; i < 5; ++i)
+        for (int j = i; j < 5; ++j) {
+            out.push_back({ { kinds[i], kinds[j] }, {} });
+            out.push_back({ { kinds[i] }, { kinds[j] } });
+        }
+
+    stable_sort(out.begin(), out.end(), [](const Material& a, const Material& b) {
+        if (a.count() != b.count()) return a.count() < b.count();
+        return a.pawns() < b.pawns();
+    });
+    return out;
+}
+
+static void registerTable(unique_ptr<Table> t) {
+    const auto& m = t->mat;
+    byKey[materialKey(m.white.data(), (int)m.white.size(), m.black.data(), (int)m.black.size())] = t.get();
+    maxLoaded = max(maxLoaded, t->mat.count());
+    tables.push_back(std::move(t));
+}
+
+int init(const string& dir) {
+    int loaded = 0;
+    for (const auto& m : allMaterials()) {
+        auto t = make_unique<Table>();
+        t->mat = m;
+
+        if (!t->file.open(dir + "/" + m.name() + ".bb")) continue;
+
+        const unsigned char* p = t->file.data();
+        uint64_t entries = 0;
+        for (int i = 0; i < 8; ++i) entries |= (uint64_t)p[8 + i] << (8 * i);
+
+        bool ok = t->file.size() == HEADER_SIZE + (m.size() + 3) / 4 &&
+                  equal(MAGIC, MAGIC + 4, p) && p[4] == m.count() && entries == m.size();
+        if (!ok) continue;
+
+        t->data = p + HEADER_SIZE;
+        registerTable(std::move(t));
+        loaded++;
+    }
+    return loaded;
+}
+
+void addTable(const Material& m, const uint8_t* packed) {
+    auto t = make_unique<Table>();
+    t->mat = m;
+    t->data = packed;
+    registerTable(std::move(t));
+}
+
+bool writeFile(const string& path, const Material& m, const vector<uint8_t>& packed) {
+    ofstream out(path, ios::binary);
+    if (!out) return false;
+
+    char header[HEADER_SIZE] = {};
+    copy(MAGIC, MAGIC + 4, header);
+    header[4] = (char)m.count();
+    uint64_t entries = m.size();
+    for (int i = 0; i < 8; ++i) header[8 + i] = (char)((entries >> (8 * i)) & 0xFF);
+
+    out.write(header, HEADER_SIZE);
+    out.write(reinterpret_cast<const char*>(packed.data()), (streamsize)packed.size());
+    return (bool)out;
+}
+
+int maxPieces() {
+    return maxLoaded;
+}
+
+bool probe(const Board& b, Value& v) {
+    if (maxLoaded == 0) return false;
+
+    const int MAX_SIDE = MAX_PIECES - 2;
+
+    int wk = -1, bk = -1;
+    Piece white[MAX_SIDE], black[MAX_SIDE];
+    int wsq[MAX_SIDE], bsq[MAX_SIDE];
+    int nw = 0, nb = 0;
+
+    for (int s = 0; s < 64; ++s) {
+        Piece p = b.sq[s];
+        if (p == Piece::Empty) continue;
+        if (p == Piece::WK) { wk = s; continue; }
+        if (p == Piece::BK) { bk = s; continue; }
+
+        if (nw + nb == MAX_SIDE) return false;        // фигур больше, чем в таблицах
+        if (p < Piece::BP) { white[nw] = p; wsq[nw++] = s; }
+        else               { black[nb] = whiteKind(p); bsq[nb++] = s; }
+    }
+    if (wk < 0 || bk < 0) return false;
+
+    // фигуры по убыванию, клетки — вместе с ними
+    auto sortSide = [](Piece* list, int* sqs, int n) {
+        for (int i = 1; i < n; ++i)
+            for (int j = i; j > 0 && list[j] > list[j - 1]; --j) {
+                swap(list[j], list[j - 1]);
+                swap(sqs[j], sqs[j - 1]);
+            }
+    };
+    sortSide(white, wsq, nw);
+    sortSide(black, bsq, nb);
+
+    // сильнейшая сторона в таблице — белые: иначе зеркалим цвета
+    bool flip = stronger(black, nb, white, nw);
+
+    auto it = flip ? byKey.find(materialKey(black, nb, white, nw))
+                   : byKey.find(materialKey(white, nw, black, nb));
+    if (it == byKey.end()) return false;
+
+    int squares[MAX_PIECES];
+    int n = 0;
+    int stm = (b.sideToMove == Color::White) ? 0 : 1;
+
+    if (!flip) {
+        squares[n++] = wk;
+        squares[n++] = bk;
+        for (int i = 0; i < nw; ++i) squares[n++] = wsq[i];
+        for (int i = 0; i < nb; ++i) squares[n++] = bsq[i];
+    } else {
+        squares[n++] = bk ^ 56;
+        squares[n++] = wk ^ 56;
+        for (int i = 0; i < nb; ++i) squares[n++] = bsq[i] ^ 56;
+        for (int i = 0; i < nw; ++i) squares[n++] = wsq[i] ^ 56;
+        stm ^= 1;
+    }
+
+    v = get(it->second->data, encode(stm, squares, n));
+    return v != ILLEGAL;
+}
+
+}
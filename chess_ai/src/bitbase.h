@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "board.h"
+
+// Битбазы WDL для эндшпилей до 4 фигур (вместе с королями).
+// Одна таблица на материал, например KRvKP. Индекс — цифры по основанию 64:
+// сторона на ходу, белый король, чёрный король, фигуры белых, фигуры чёрных
+// (в порядке Material). 2 бита на позицию, файл <dir>/<name>.bb читается через mmap.
+// В таблице сильнейшая сторона — белые; иначе позиция пробуется через зеркало цветов.
+namespace Bitbase {
+    enum Value : uint8_t {
+        DRAW = 0,
+        WIN = 1,       // для стороны на ходу
+        LOSS = 2,
+        ILLEGAL = 3
+    };
+
+    const int MAX_PIECES = 4;
+
+    // фигуры кроме королей; в белом виде (WP..WQ), по убыванию ценности
+    struct Material {
+        std::vector<Piece> white, black;
+
+        std::string name() const;          // "KRvKP"
+        int count() const { return 2 + (int)white.size() + (int)black.size(); }
+        int pawns() const;
+        uint64_t size() const { return 2ULL << (6 * count()); }
+    };
+
+    // все таблицы 3 и 4 фигур в порядке генерации:
+    // сначала меньше фигур, потом меньше пешек (взятия и превращения ведут в готовые)
+    std::vector<Material> allMaterials();
+
+    inline uint64_t encode(int stm, const int* squares, int n) {
+        uint64_t idx = (uint64_t)stm;
+        for (int i = 0; i < n; ++i) idx = (idx << 6) | (uint64_t)squares[i];
+        return idx;
+    }
+
+    inline Value get(const uint8_t* packed, uint64_t idx) {
+        return (Value)((packed[idx >> 2] >> ((idx & 3) * 2)) & 3);
+    }
+
+    // загрузить все имеющиеся таблицы из dir (до начала поисков); число загруженных
+    int init(const std::string& dir);
+
+    // таблица в памяти (для генератора); данные должны жить, пока используются
+    void addTable(const Material& m, const uint8_t* packed);
+
+    bool writeFile(const std::string& path, const Material& m, const std::vector<uint8_t>& packed);
+
+    int maxPieces();                       // 0 — таблиц нет
+
+    // результат для стороны на ходу; false — таблицы для этого материала нет.
+    // Рокировки и en passant не учитываются.
+    bool probe(const Board& b, Value& v);
+}
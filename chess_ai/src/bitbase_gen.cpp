@@ -0,0 +1,325 @@
+// bitbase_gen: ретроградный анализ всех 3- и 4-фигурных эндшпилей.
+// Запуск: bitbase_gen [каталог] [потоков] [KRvK ...]
+// Без списка таблиц строятся все отсутствующие в каталоге.
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <bit>
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "bitbase.h"
+#include "attacks.h"
+
+using namespace std;
+
+// состояния позиции при генерации
+enum : uint8_t { G_UNKNOWN = 0, G_WIN, G_LOSS, G_ILLEGAL, G_DRAW };
+
+static bool isWhitePiece(Piece p) { return p >= Piece::WP && p <= Piece::WK; }
+
+static Piece pieceKind(Piece p) {
+    return isWhitePiece(p) ? p : (Piece)((int)p - 6);
+}
+
+static void decode(uint64_t idx, int n, int& stm, int* sq) {
+    for (int i = n - 1; i >= 0; --i) {
+        sq[i] = (int)(idx & 63);
+        idx >>= 6;
+    }
+    stm = (int)idx;
+}
+
+// f(from, to) по диапазонам [0, n) в нескольких потоках
+template <class F>
+static void parallelFor(int threads, uint64_t n, F f) {
+    vector<thread> pool;
+    uint64_t chunk = (n + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        uint64_t from = chunk * t;
+        uint64_t to = min(n, from + chunk);
+        if (from >= to) break;
+        pool.emplace_back([&f, t, from, to]() { f(t, from, to); });
+    }
+    for (auto& th : pool) th.join();
+}
+
+class Generator {
+public:
+    Generator(const Bitbase::Material& m, int threads)
+        : mat(m), threads(threads), n(m.count()), size(m.size()),
+          state(new atomic<uint8_t>[size]), count(new atomic<uint8_t>[size])
+    {
+        piece[0] = Piece::WK;
+        piece[1] = Piece::BK;
+        int k = 2;
+        for (Piece p : m.white) piece[k++] = p;
+        for (Piece p : m.black) piece[k++] = (Piece)((int)p + 6);
+    }
+
+    vector<uint8_t> run() {
+        // 1. легальность, маты, взятия и превращения (по готовым таблицам)
+        vector<vector<uint32_t>> part(threads);
+        parallelFor(threads, size, [&](int t, uint64_t from, uint64_t to) {
+            initRange(from, to, part[t]);
+        });
+
+        // 2. ретроградное распространение по уровням
+        vector<uint32_t> frontier = merge(part);
+        while (!frontier.empty()) {
+            for (auto& p : part) p.clear();
+            parallelFor(threads, frontier.size(), [&](int t, uint64_t from, uint64_t to) {
+                for (uint64_t i = from; i < to; ++i) propagate(frontier[i], part[t]);
+            });
+            frontier = merge(part);
+        }
+
+        // 3. упаковка: неразрешённые — ничьи
+        vector<uint8_t> packed((size + 3) / 4, 0);
+        for (uint64_t idx = 0; idx < size; ++idx) {
+            uint8_t s = state[idx].load(memory_order_relaxed);
+            Bitbase::Value v = (s == G_WIN) ? Bitbase::WIN
+                             : (s == G_LOSS) ? Bitbase::LOSS
+                             : (s == G_ILLEGAL) ? Bitbase::ILLEGAL
+                             : Bitbase::DRAW;
+            packed[idx >> 2] |= (uint8_t)(v << ((idx & 3) * 2));
+            stats[v]++;
+        }
+        return packed;
+    }
+
+    uint64_t stats[4] = {};
+
+private:
+    static vector<uint32_t> merge(vector<vector<uint32_t>>& part) {
+        vector<uint32_t> all;
+        for (auto& p : part) all.insert(all.end(), p.begin(), p.end());
+        return all;
+    }
+
+    static bool resolve(atomic<uint8_t>& s, uint8_t v) {
+        uint8_t expected = G_UNKNOWN;
+        return s.compare_exchange_strong(expected, v, memory_order_relaxed);
+    }
+
+    void initRange(uint64_t from, uint64_t to, vector<uint32_t>& frontier) {
+        Board b;
+        vector<Move> legal;
+        int sq[Bitbase::MAX_PIECES];
+        int stm;
+
+        for (uint64_t idx = from; idx < to; ++idx) {
+            decode(idx, n, stm, sq);
+            count[idx].store(0, memory_order_relaxed);
+
+            // клетки не совпадают, пешки не на крайних рядах
+            bool ok = true;
+            uint64_t occ = 0;
+            for (int i = 0; i < n && ok; ++i) {
+                if (occ >> sq[i] & 1) ok = false;
+                occ |= 1ULL << sq[i];
+                int r = Board::rankOf(sq[i]);
+                if (pieceKind(piece[i]) == Piece::WP && (r == 0 || r == 7)) ok = false;
+            }
+            if (!ok) {
+                state[idx].store(G_ILLEGAL, memory_order_relaxed);
+                continue;
+            }
+
+            b.sq.fill(Piece::Empty);
+            for (int i = 0; i < n; ++i) b.sq[sq[i]] = piece[i];
+            b.sideToMove = stm == 0 ? Color::White : Color::Black;
+            b.castlingRights = 0;
+            b.enPassantSquare = -1;
+            b.halfmoveClock = 0;
+
+            Color us = b.sideToMove;
+            Color them = (us == Color::White) ? Color::Black : Color::White;
+
+            if (b.inCheck(them)) {                  // ход не у той стороны
+                state[idx].store(G_ILLEGAL, memory_order_relaxed);
+                continue;
+            }
+
+            legal.clear();
+            MoveGen::generateLegalMoves(b, legal);
+
+            if (legal.empty()) {
+                bool mate = b.inCheck(us);
+                state[idx].store(mate ? G_LOSS : G_DRAW, memory_order_relaxed);
+                if (mate) frontier.push_back((uint32_t)idx);
+                continue;
+            }
+
+            int open = 0;        // ходы, которые ещё могут не проиграть
+            bool win = false;
+
+            for (const auto& m : legal) {
+                if (!m.isCapture && !m.isEnPassant && m.promotion == Piece::Empty) {
+                    open++;                         // ход внутри этой таблицы
+                    continue;
+                }
+
+                Undo u;
+                b.makeMove(m, u);
+                Bitbase::Value v = childValue(b);
+                b.unmakeMove(m, u);
+
+                if (v == Bitbase::LOSS) { win = true; break; }
+                if (v == Bitbase::DRAW) open++;     // ничья: этот счётчик не уменьшится
+            }
+
+            if (win || open == 0) {
+                state[idx].store(win ? G_WIN : G_LOSS, memory_order_relaxed);
+                frontier.push_back((uint32_t)idx);
+            } else {
+                state[idx].store(G_UNKNOWN, memory_order_relaxed);
+                count[idx].store((uint8_t)open, memory_order_relaxed);
+            }
+        }
+    }
+
+    // позиция после взятия или превращения — из меньшей таблицы
+    Bitbase::Value childValue(const Board& b) const {
+        int pieces = 0;
+        for (Piece p : b.sq) pieces += (p != Piece::Empty);
+        if (pieces == 2) return Bitbase::DRAW;      // голые короли
+
+        Bitbase::Value v;
+        if (!Bitbase::probe(b, v)) {
+            cerr << "missing sub-table for " << mat.name() << "\n";
+            exit(1);
+        }
+        return v;
+    }
+
+    // позиция idx решена: предшественники (ход сделала другая сторона)
+    void propagate(uint32_t idx, vector<uint32_t>& next) {
+        int sq[Bitbase::MAX_PIECES];
+        int stm;
+        decode(idx, n, stm, sq);
+
+        bool lost = state[idx].load(memory_order_relaxed) == G_LOSS;
+        int mover = stm ^ 1;
+
+        uint64_t occ = 0;
+        for (int i = 0; i < n; ++i) occ |= 1ULL << sq[i];
+
+        auto visit = [&](int i, int t) {
+            int prev[Bitbase::MAX_PIECES];
+            copy(sq, sq + n, prev);
+            prev[i] = t;
+            uint64_t p = Bitbase::encode(mover, prev, n);
+
+            if (state[p].load(memory_order_relaxed) != G_UNKNOWN) return;
+
+            if (lost) {
+                if (resolve(state[p], G_WIN)) next.push_back((uint32_t)p);
+            } else if (count[p].fetch_sub(1, memory_order_relaxed) == 1) {
+                if (resolve(state[p], G_LOSS)) next.push_back((uint32_t)p);
+            }
+        };
+
+        // лучи ладьи (0..3) и слона (4..7)
+        static const int RAY_D[8][2] = { {1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1} };
+
+        for (int i = 0; i < n; ++i) {
+            if (isWhitePiece(piece[i]) != (mover == 0)) continue;
+
+            int s = sq[i];
+            int f0 = Board::fileOf(s), r0 = Board::rankOf(s);
+            Piece kind = pieceKind(piece[i]);
+
+            auto empty = [&](int f, int r) {
+                return f >= 0 && f < 8 && r >= 0 && r < 8 && !(occ >> (r * 8 + f) & 1);
+            };
+
+            if (kind == Piece::WK || kind == Piece::WN) {
+                uint64_t to = ((kind == Piece::WK) ? Attacks::KING[s] : Attacks::KNIGHT[s]) & ~occ;
+                for (; to; to &= to - 1) visit(i, countr_zero(to));
+            } else if (kind == Piece::WP) {
+                // пешка пришла с соседней клетки назад (или через одну со стартовой)
+                int dir = (mover == 0) ? -1 : 1;
+                int start = (mover == 0) ? 1 : 6;
+                int r1 = r0 + dir;
+                if (r1 >= 1 && r1 <= 6 && empty(f0, r1)) {
+                    visit(i, r1 * 8 + f0);
+                    int r2 = r1 + dir;
+                    if (r2 == start && empty(f0, r2)) visit(i, r2 * 8 + f0);
+                }
+            } else {
+                int from = (kind == Piece::WB) ? 4 : 0;
+                int to = (kind == Piece::WR) ? 4 : 8;
+                for (int k = from; k < to; ++k) {
+                    int f = f0 + RAY_D[k][0], r = r0 + RAY_D[k][1];
+                    while (empty(f, r)) {
+                        visit(i, r * 8 + f);
+                        f += RAY_D[k][0];
+                        r += RAY_D[k][1];
+                    }
+                }
+            }
+        }
+    }
+
+    Bitbase::Material mat;
+    int threads;
+    int n;
+    uint64_t size;
+    Piece piece[Bitbase::MAX_PIECES];
+    unique_ptr<atomic<uint8_t>[]> state;
+    unique_ptr<atomic<uint8_t>[]> count;   // ходы без выхода в выигрыш соперника
+};
+
+int main(int argc, char** argv) {
+    string dir = (argc > 1) ? argv[1] : "assets/bitbases";
+    int threads = (argc > 2) ? stoi(argv[2]) : (int)max(1u, thread::hardware_concurrency());
+
+    vector<string> only;
+    for (int i = 3; i < argc; ++i) only.push_back(argv[i]);
+
+    filesystem::create_directories(dir);
+    Bitbase::init(dir);                             // готовые таблицы нужны для взятий
+
+    vector<unique_ptr<vector<uint8_t>>> built;      // таблицы в памяти до конца работы
+
+    for (const auto& m : Bitbase::allMaterials()) {
+        string name = m.name();
+        string path = dir + "/" + name + ".bb";
+
+        if (!only.empty() && find(only.begin(), only.end(), name) == only.end()) continue;
+        if (only.empty() && filesystem::exists(path)) {
+            cout << name << ": exists\n";
+            continue;
+        }
+
+        auto t0 = chrono::steady_clock::now();
+
+        Generator gen(m, threads);
+        auto packed = make_unique<vector<uint8_t>>(gen.run());
+
+        if (!Bitbase::writeFile(path, m, *packed)) {
+            cerr << name << ": cannot write " << path << "\n";
+            return 1;
+        }
+        Bitbase::addTable(m, packed->data());
+        built.push_back(std::move(packed));
+
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        cout << name << ": win " << gen.stats[Bitbase::WIN]
+             << " draw " << gen.stats[Bitbase::DRAW]
+             << " loss " << gen.stats[Bitbase::LOSS]
+             << " illegal " << gen.stats[Bitbase::ILLEGAL]
+             << " (" << sec << " s)\n";
+    }
+    return 0;
+}
@@ -3,7 +3,9 @@
 #include <vector>
 #include <cstdlib> 
 #include "move.h"
+#include "attacks.h"
 #include <random>
+#include <bit>
 
 using namespace std;
 
@@ -45,6 +47,29 @@ static vector<string> splitWS(const string& str) {
     return parts;
 }
 
+static uint64_t zobrist[13][64];
+static uint64_t zobristSide;
+static uint64_t zobristCastle[16];  
+static uint64_t zobristEPFile[8];   
+
+// один раз на процесс; потоки матча могут прийти сюда одновременно
+static void initZobrist() {
+    static const bool done = [] {
+        std::mt19937_64 rng(20230817);
+
+        for (int p = 0; p < 13; ++p)
+            for (int s = 0; s < 64; ++s)
+                zobrist[p][s] = rng();
+
+        zobristSide = rng();
+
+        for (int i = 0; i < 16; ++i) zobristCastle[i] = rng();
+        for (int f = 0; f < 8; ++f)  zobristEPFile[f] = rng();
+        return true;
+    }();
+    (void)done;
+}
+
 Board::Board() { setStartPos(); }
 
 void Board::setStartPos() {
@@ -124,6 +149,8 @@ bool Board::setFromFEN(const string& fen) {
         if (fullmoveNumber == 0) fullmoveNumber = 1;
     }
 
+    hash = computeHash();
+    pawnHash = computePawnHash();
     return true;
 }
 
@@ -175,6 +202,8 @@ bool Board::makeSimpleMove(const Move& m) {
                     ? Color::Black
                     : Color::White;
 
+    hash = computeHash();
+    pawnHash = computePawnHash();
     return true;
 }
 
@@ -189,6 +218,8 @@ bool Board::makeMove(const Move& m, Undo& u) {
     u.prevHalfmoveClock = halfmoveClock;
     u.prevFullmoveNumber = fullmoveNumber;
     u.prevSideToMove = sideToMove;
+    u.prevHash = hash;
+    u.prevPawnHash = pawnHash;
 
     u.captured = Piece::Empty;
     u.capturedSquare = -1;
@@ -200,6 +231,14 @@ bool Board::makeMove(const Move& m, Undo& u) {
 
     Piece movedPiece = sq[m.from];
 
+    // ключ: снимаем старые права и en passant, потом ставим новые
+    uint64_t h = hash ^ zobristCastle[castlingRights & 15];
+    if (enPassantSquare >= 0) h ^= zobristEPFile[fileOf(enPassantSquare)];
+    h ^= zobrist[(int)movedPiece][m.from];
+
+    bool pawnMove = (movedPiece == Piece::WP || movedPiece == Piece::BP);
+    if (pawnMove) pawnHash ^= zobrist[(int)movedPiece][m.from];
+
     enPassantSquare = -1;
 
 
@@ -212,11 +251,16 @@ bool Board::makeMove(const Move& m, Undo& u) {
         u.captured = sq[capSq];
 
         sq[capSq] = Piece::Empty;
+        h ^= zobrist[(int)u.captured][capSq];
+        pawnHash ^= zobrist[(int)u.captured][capSq];
 
     } else if (sq[m.to] != Piece::Empty) {
 
         u.capturedSquare = m.to;
         u.captured = sq[m.to];
+        h ^= zobrist[(int)u.captured][m.to];
+        if (u.captured == Piece::WP || u.captured == Piece::BP)
+            pawnHash ^= zobrist[(int)u.captured][m.to];
 
     }
     sq[m.to] = sq[m.from];
@@ -235,14 +279,17 @@ bool Board::makeMove(const Move& m, Undo& u) {
 
         sq[u.rookTo] = sq[u.rookFrom];
         sq[u.rookFrom] = Piece::Empty;
+        h ^= zobrist[(int)u.rookPiece][u.rookFrom] ^ zobrist[(int)u.rookPiece][u.rookTo];
     }
 
     if (m.promotion != Piece::Empty) {
         sq[m.to] = m.promotion;
     }
+    h ^= zobrist[(int)sq[m.to]][m.to];
+    if (sq[m.to] == Piece::WP || sq[m.to] == Piece::BP) pawnHash ^= zobrist[(int)sq[m.to]][m.to];
 
 
-    if (movedPiece == Piece::WP || movedPiece == Piece::BP) {
+    if (pawnMove) {
 
         int diff = m.to - m.from;
 
@@ -276,7 +323,6 @@ bool Board::makeMove(const Move& m, Undo& u) {
     }
 
 
-    bool pawnMove = (movedPiece == Piece::WP || movedPiece == Piece::BP);
     bool capture  = (u.captured != Piece::Empty);
 
     if (pawnMove || capture)
@@ -289,6 +335,10 @@ bool Board::makeMove(const Move& m, Undo& u) {
 
     sideToMove = (sideToMove == Color::White) ? Color::Black : Color::White;
 
+    h ^= zobristCastle[castlingRights & 15] ^ zobristSide;
+    if (enPassantSquare >= 0) h ^= zobristEPFile[fileOf(enPassantSquare)];
+    hash = h;
+
     return true;
 }
 
@@ -296,6 +346,8 @@ bool Board::makeMove(const Move& m, Undo& u) {
 void Board::unmakeMove(const Move& m, const Undo& u) {
 
     sideToMove = u.prevSideToMove;
+    hash = u.prevHash;
+    pawnHash = u.prevPawnHash;
 
     castlingRights = u.prevCastlingRights;
     enPassantSquare = u.prevEnPassantSquare;
@@ -319,6 +371,41 @@ void Board::unmakeMove(const Move& m, const Undo& u) {
     }
 }
 
+// Нулевой ход: только передача очереди (для null-move pruning)
+void Board::makeNullMove(Undo& u) {
+    u.moved = Piece::Empty;
+    u.captured = Piece::Empty;
+    u.capturedSquare = -1;
+    u.wasCastling = false;
+
+    u.prevCastlingRights = castlingRights;
+    u.prevEnPassantSquare = enPassantSquare;
+    u.prevHalfmoveClock = halfmoveClock;
+    u.prevFullmoveNumber = fullmoveNumber;
+    u.prevSideToMove = sideToMove;
+    u.prevHash = hash;
+
+    if (enPassantSquare >= 0) hash ^= zobristEPFile[fileOf(enPassantSquare)];
+    hash ^= zobristSide;
+
+    enPassantSquare = -1;
+    halfmoveClock++;
+
+    if (sideToMove == Color::Black)
+        fullmoveNumber++;
+
+    sideToMove = (sideToMove == Color::White) ? Color::Black : Color::White;
+}
+
+void Board::unmakeNullMove(const Undo& u) {
+    sideToMove = u.prevSideToMove;
+    hash = u.prevHash;
+    castlingRights = u.prevCastlingRights;
+    enPassantSquare = u.prevEnPassantSquare;
+    halfmoveClock = u.prevHalfmoveClock;
+    fullmoveNumber = u.prevFullmoveNumber;
+}
+
 
 
 static bool isWhitePiece(Piece p) { return p >= Piece::WP && p <= Piece::WK; }
@@ -343,120 +430,83 @@ bool Board::isSquareAttacked(int s, Color bySide) const {
     if (s < 0 || s >= 64) return false;
 
     bool byWhite = (bySide == Color::White);
-    int f0 = fileOf(s);
-    int r0 = rankOf(s);
-
-    //  Ход Пешек
-    if (byWhite) {
-        if (f0 > 0) {
-            int from = s - 9;
-            if (from >= 0 && sq[from] == Piece::WP) return true;
-        }
-        if (f0 < 7) {
-            int from = s - 7;
-            if (from >= 0 && sq[from] == Piece::WP) return true;
-        }
-    } else {
-        if (f0 > 0) {
-            int from = s + 7;
-            if (from < 64 && sq[from] == Piece::BP) return true;
-        }
-        if (f0 < 7) {
-            int from = s + 9;
-            if (from < 64 && sq[from] == Piece::BP) return true;
-        }
-    }
-
-    // Ход Коня
-    static const int kJumps[8] = { -17, -15, -10, -6, 6, 10, 15, 17 };
-    Piece atkKnight = byWhite ? Piece::WN : Piece::BN;
-
-    for (int d : kJumps) {
-        int from = s + d;
-        if (from < 0 || from >= 64) continue;
 
-        int df = abs(fileOf(from) - f0);
-        int dr = abs(rankOf(from) - r0);
-        if (!((df == 1 && dr == 2) || (df == 2 && dr == 1))) continue;
+    // Пешки, конь, король: клетки, откуда они бьют s
+    Piece atkPawn = byWhite ? Piece::WP : Piece::BP;
+    for (uint64_t bb = Attacks::PAWN[byWhite ? 1 : 0][s]; bb; bb &= bb - 1)
+        if (sq[countr_zero(bb)] == atkPawn) return true;
 
-        if (sq[from] == atkKnight) return true;
-    }
+    Piece atkKnight = byWhite ? Piece::WN : Piece::BN;
+    for (uint64_t bb = Attacks::KNIGHT[s]; bb; bb &= bb - 1)
+        if (sq[countr_zero(bb)] == atkKnight) return true;
 
-    // Ход Короля
     Piece atkKing = byWhite ? Piece::WK : Piece::BK;
-    for (int dr = -1; dr <= 1; ++dr) {
-        for (int df = -1; df <= 1; ++df) {
-            if (dr == 0 && df == 0) continue;
-            int f = f0 + df;
-            int r = r0 + dr;
-            if (f < 0 || f > 7 || r < 0 || r > 7) continue;
-            int from = r * 8 + f;
-            if (sq[from] == atkKing) return true;
-        }
+    for (uint64_t bb = Attacks::KING[s]; bb; bb &= bb - 1)
+        if (sq[countr_zero(bb)] == atkKing) return true;
+
+    // Слон, ладья, ферзь: кандидаты на лучах из s, потом клетки BETWEEN
+    // между кандидатом и s должны быть пусты
+    Piece atkBishop = byWhite ? Piece::WB : Piece::BB;
+    Piece atkRook = byWhite ? Piece::WR : Piece::BR;
+    Piece atkQueen = byWhite ? Piece::WQ : Piece::BQ;
+
+    uint64_t sliders = 0;
+    for (uint64_t bb = Attacks::BISHOP_RAYS[s]; bb; bb &= bb - 1) {
+        int from = countr_zero(bb);
+        if (sq[from] == atkBishop || sq[from] == atkQueen) sliders |= 1ULL << from;
+    }
+    for (uint64_t bb = Attacks::ROOK_RAYS[s]; bb; bb &= bb - 1) {
+        int from = countr_zero(bb);
+        if (sq[from] == atkRook || sq[from] == atkQueen) sliders |= 1ULL << from;
     }
 
-    // Ход Слона, Ферзя
-    auto diagRay = [&](int df, int dr) -> bool {
-        int f = f0, r = r0;
-        while (true) {
-            f += df; r += dr;
-            if (f < 0 || f > 7 || r < 0 || r > 7) return false;
-            int from = r * 8 + f;
-            Piece p = sq[from];
-            if (p == Piece::Empty) continue;
-            if (byWhite) return (p == Piece::WB || p == Piece::WQ);
-            else        return (p == Piece::BB || p == Piece::BQ);
-        }
-    };
-
-    if (diagRay(+1, +1)) return true;
-    if (diagRay(-1, +1)) return true;
-    if (diagRay(+1, -1)) return true;
-    if (diagRay(-1, -1)) return true;
-
-    // Ход Ладьи, Ферзя
-    auto lineRay = [&](int df, int dr) -> bool {
-        int f = f0, r = r0;
-        while (true) {
-            f += df; r += dr;
-            if (f < 0 || f > 7 || r < 0 || r > 7) return false;
-            int from = r * 8 + f;
-            Piece p = sq[from];
-            if (p == Piece::Empty) continue;
-            if (byWhite) return (p == Piece::WR || p == Piece::WQ);
-            else        return (p == Piece::BR || p == Piece::BQ);
-        }
-    };
-
-    if (lineRay(+1, 0)) return true;
-    if (lineRay(-1, 0)) return true;
-    if (lineRay(0, +1)) return true;
-    if (lineRay(0, -1)) return true;
+    for (; sliders; sliders &= sliders - 1) {
+        uint64_t between = Attacks::BETWEEN[s][countr_zero(sliders)];
+        while (between && sq[countr_zero(between)] == Piece::Empty) between &= between - 1;
+        if (!between) return true;
+    }
 
     return false;
 }
 
-static uint64_t zobrist[13][64];
-static uint64_t zobristSide;
-static uint64_t zobristCastle[16];  
-static uint64_t zobristEPFile[8];   
-static bool zobristInit = false;
-
-static void initZobrist() {
-    if (zobristInit) return;
+uint64_t Board::occupancy() const {
+    uint64_t occ = 0;
+    for (int i = 0; i < 64; ++i)
+        if (sq[i] != Piece::Empty) occ |= 1ULL << i;
+    return occ;
+}
 
-    std::mt19937_64 rng(20230817);
+uint64_t Board::attackersTo(int s, uint64_t occ) const {
+    uint64_t att = 0;
 
-    for (int p = 0; p < 13; ++p)
-        for (int s = 0; s < 64; ++s)
-            zobrist[p][s] = rng();
+    // Пешки, кони и короли: кандидаты из таблицы, бьющие s
+    auto leapers = [&](uint64_t from, Piece a, Piece b) {
+        for (uint64_t bb = from & occ; bb; bb &= bb - 1) {
+            int f = countr_zero(bb);
+            if (sq[f] == a || sq[f] == b) att |= 1ULL << f;
+        }
+    };
 
-    zobristSide = rng();
+    leapers(Attacks::PAWN[1][s], Piece::WP, Piece::WP);
+    leapers(Attacks::PAWN[0][s], Piece::BP, Piece::BP);
+    leapers(Attacks::KNIGHT[s], Piece::WN, Piece::BN);
+    leapers(Attacks::KING[s], Piece::WK, Piece::BK);
+
+    // Дальнобойные: на луче из s и ничего из occ между
+    auto sliders = [&](uint64_t rays, Piece a, Piece b) {
+        for (uint64_t bb = rays & occ; bb; bb &= bb - 1) {
+            int f = countr_zero(bb);
+            Piece p = sq[f];
+            if ((p == a || p == b || p == Piece::WQ || p == Piece::BQ) &&
+                !(Attacks::BETWEEN[s][f] & occ))
+                att |= 1ULL << f;
+        }
+    };
 
-    for (int i = 0; i < 16; ++i) zobristCastle[i] = rng();
-    for (int f = 0; f < 8; ++f)  zobristEPFile[f] = rng();
+    sliders(Attacks::BISHOP_RAYS[s], Piece::WB, Piece::BB);
+    sliders(Attacks::ROOK_RAYS[s], Piece::WR, Piece::BR);
 
-    zobristInit = true;
+    return att;
 }
 
 uint64_t Board::computeHash() const {
@@ -482,4 +532,14 @@ uint64_t Board::computeHash() const {
     }
 
     return h;
-}
\ No newline at end of file
+}
+
+uint64_t Board::computePawnHash() const {
+    initZobrist();
+
+    uint64_t h = 0;
+    for (int sqi = 0; sqi < 64; ++sqi)
+        if (sq[sqi] == Piece::WP || sq[sqi] == Piece::BP)
+            h ^= zobrist[(int)sq[sqi]][sqi];
+    return h;
+}
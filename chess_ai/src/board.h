@@ -26,6 +26,8 @@ struct Undo {
     uint16_t prevHalfmoveClock = 0;
     uint16_t prevFullmoveNumber = 1;
     Color prevSideToMove = Color::White;
+    uint64_t prevHash = 0;
+    uint64_t prevPawnHash = 0;
 };
 
 struct Move;
@@ -44,7 +46,13 @@ public:
 
     uint16_t halfmoveClock = 0;
     uint16_t fullmoveNumber = 1;
+
+    // Zobrist-ключ, обновляется в makeMove/unmakeMove; computeHash() — с нуля.
+    // После прямой правки sq нужно пересчитать: hash = computeHash()
+    uint64_t hash = 0;
+    uint64_t pawnHash = 0;              // только пешки (для кэша пешечной структуры)
     uint64_t computeHash() const;
+    uint64_t computePawnHash() const;
 
     Board();
     
@@ -54,9 +62,14 @@ public:
     bool setFromFEN(const std::string& fen);
     int kingSquare(Color side) const;
     bool isSquareAttacked(int square, Color bySide) const;
+    uint64_t occupancy() const;
+    // все фигуры (обоих цветов), бьющие square; учитываются только клетки из occ
+    uint64_t attackersTo(int square, uint64_t occ) const;
     bool inCheck(Color side) const;
     bool makeMove(const Move& m, Undo& u);
     void unmakeMove(const Move& m, const Undo& u);
+    void makeNullMove(Undo& u);
+    void unmakeNullMove(const Undo& u);
 
     std::string toString() const;
 
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <random>
+#include "board.h"
+#include "move.h"
+#include "mapped_file.h"
+
+// Дебютная книга Polyglot (.bin): файл отображается в память,
+// позиция ищется бинарным поиском по ключу Polyglot.
+class PolyglotBook {
+public:
+    enum class Pick {
+        BestWeight,   // всегда ход с наибольшим весом
+        Weighted      // случайно, пропорционально весу
+    };
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    // dir/book.bin
+    bool openDir(const std::string& dir);
+
+    void setPick(Pick p) { pick = p; }
+    void setSeed(uint32_t seed) { rng.seed(seed); }
+
+    // ключ Polyglot (не совпадает с Board::computeHash)
+    static uint64_t key(const Board& b);
+
+    // встроенная Random64 даёт известный ключ начальной позиции
+    static bool randomOk();
+
+    // ход из книги; false — позиции нет в книге
+    bool probe(const Board& b, Move& out);
+
+private:
+    MappedFile file;
+    size_t entries = 0;                   // записей по 16 байт
+
+    Pick pick = Pick::Weighted;
+    std::mt19937 rng{ std::random_device{}() };
+};
@@ -0,0 +1,60 @@
+#include "cpu.h"
+
+#if CPU_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if CPU_X86
+
+static bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    bool osxsave = (r[2] >> 27) & 1, avx = (r[2] >> 28) & 1;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;   // ОС сохраняет YMM
+    __cpuidex(r, 7, 0);
+    return (r[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool cpuHasSse41() {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 1);
+    return (r[2] >> 19) & 1;
+#else
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+#endif // CPU_X86
+
+static Cpu::Simd detect() {
+#if CPU_X86
+    if (cpuHasAvx2()) return Cpu::Simd::AVX2;
+    if (cpuHasSse41()) return Cpu::Simd::SSE41;
+#endif
+    return Cpu::Simd::Scalar;
+}
+
+namespace Cpu {
+
+Simd best() {
+    static const Simd s = detect();
+    return s;
+}
+
+const char* name(Simd s) {
+    switch (s) {
+        case Simd::AVX2:  return "AVX2";
+        case Simd::SSE41: return "SSE4.1";
+        default:          return "scalar";
+    }
+}
+
+}
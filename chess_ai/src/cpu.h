@@ -0,0 +1,25 @@
+#pragma once
+
+// Наборы SIMD-инструкций и выбор во время работы. Функции с интринсиками
+// помечаются TARGET_AVX2 / TARGET_SSE41 (глобальные флаги компилятора
+// не нужны) и вызываются, только если Cpu::best() их поддерживает.
+namespace Cpu {
+    enum class Simd { Scalar, SSE41, AVX2 };
+
+    Simd best();                         // определяется один раз
+    const char* name(Simd s);
+}
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+#if CPU_X86 && defined(__GNUC__)
+#define TARGET_AVX2  __attribute__((target("avx2")))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define TARGET_AVX2
+#define TARGET_SSE41
+#endif
@@ -1,179 +1,537 @@
 #include "eval.h"
+#include "attacks.h"
+#include "eval_params.h"
 #include <algorithm>
+#include <array>
+#include <bit>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
 
 using namespace std;
+using namespace EvalParams;
 
-static inline bool isWhite(Piece p) { return p >= Piece::WP && p <= Piece::WK; }
-static inline bool isBlack(Piece p) { return p >= Piece::BP && p <= Piece::BK; }
+static constexpr bool isWhite(Piece p) { return p >= Piece::WP && p <= Piece::WK; }
+static constexpr bool isBlack(Piece p) { return p >= Piece::BP && p <= Piece::BK; }
 
-static int pieceValue(Piece p) {
-    switch (p) {
-        case Piece::WP: case Piece::BP: return 100;
-        case Piece::WN: case Piece::BN: return 320;
-        case Piece::WB: case Piece::BB: return 330;
-        case Piece::WR: case Piece::BR: return 500;
-        case Piece::WQ: case Piece::BQ: return 900;
-        case Piece::WK: case Piece::BK: return 0;
-        default: return 0;
-    }
+static constexpr int mirror64(int sq) {
+    return sq ^ 56;
 }
 
-static inline int mirror64(int sq) {
-    return sq ^ 56;
+// Все веса — из eval_params.h (его перезаписывает chess_tuner).
+
+// Материал + PST одной таблицей, со знаком за белых, чёрные уже отражены;
+// считается при компиляции. Короли здесь нули: их PST смешивается по фазе.
+// Общая для Eval::score и Batch.
+static constexpr auto PIECE_SQ = [] {
+    array<array<int16_t, 64>, 13> t{};
+    for (int pc = 1; pc <= 12; ++pc) {
+        Piece p = (Piece)pc;
+        if (p == Piece::WK || p == Piece::BK) continue;
+
+        const int* pst = nullptr;
+        switch ((pc - 1) % 6) {
+            case 0: pst = PST_PAWN; break;
+            case 1: pst = PST_KNIGHT; break;
+            case 2: pst = PST_BISHOP; break;
+            case 3: pst = PST_ROOK; break;
+            default: pst = PST_QUEEN; break;
+        }
+
+        bool w = isWhite(p);
+        for (int s = 0; s < 64; ++s) {
+            int v = PIECE_VALUE[(pc - 1) % 6] + pst[w ? s : mirror64(s)];
+            t[pc][s] = (int16_t)(w ? v : -v);
+        }
+    }
+    return t;
+}();
+
+// Грубая оценка “насколько эндшпиль”: чем меньше тяжёлых фигур — тем ближе
+static constexpr int PHASE[13] = { 0, 0, 1, 1, 2, 4, 0, 0, 1, 1, 2, 4, 0 };
+
+// вес эндшпиля (из 256) по фазе 0..24
+static constexpr auto EG_WEIGHT = [] {
+    array<int, 25> t{};
+    for (int ph = 0; ph <= 24; ++ph) t[ph] = (24 - ph) * 256 / 24;
+    return t;
+}();
+
+// PST королей со знаком за белых, чёрные отражены: [цвет][0 — миддлгейм, 1 — эндшпиль][клетка]
+static constexpr auto KING_SQ = [] {
+    array<array<array<int16_t, 64>, 2>, 2> t{};
+    for (int s = 0; s < 64; ++s) {
+        t[0][0][s] = (int16_t)PST_KING_MG[s];
+        t[0][1][s] = (int16_t)PST_KING_EG[s];
+        t[1][0][s] = (int16_t)-PST_KING_MG[mirror64(s)];
+        t[1][1][s] = (int16_t)-PST_KING_EG[mirror64(s)];
+    }
+    return t;
+}();
+
+static inline int kingPst(int c, int s, int mgW, int egW) {
+    return (KING_SQ[c][0][s] * mgW + KING_SQ[c][1][s] * egW) / 256;
 }
 
+// ---- Пешечная структура ----
+// Зависит только от пешек: считается операциями над битбордами пешек
+// (без цикла по пешкам) и кэшируется по Board::pawnHash.
 
-// Пешка: поощряем продвижение и центр
-static const int PST_PAWN[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-     5, 10, 10,-20,-20, 10, 10,  5,
-     5, -5,-10,  0,  0,-10, -5,  5,
-     0,  0,  0, 20, 20,  0,  0,  0,
-     5,  5, 10, 25, 25, 10,  5,  5,
-    10, 10, 20, 30, 30, 20, 10, 10,
-    50, 50, 50, 50, 50, 50, 50, 50,
-     0,  0,  0,  0,  0,  0,  0,  0
-};
+static constexpr uint64_t FILE_A = 0x0101010101010101ULL;
+static constexpr uint64_t FILE_H = FILE_A << 7;
 
-// Конь: сильный центр, слабые края
-static const int PST_KNIGHT[64] = {
-   -50,-40,-30,-30,-30,-30,-40,-50,
-   -40,-20,  0,  5,  5,  0,-20,-40,
-   -30,  5, 10, 15, 15, 10,  5,-30,
-   -30,  0, 15, 20, 20, 15,  0,-30,
-   -30,  5, 15, 20, 20, 15,  5,-30,
-   -30,  0, 10, 15, 15, 10,  0,-30,
-   -40,-20,  0,  0,  0,  0,-20,-40,
-   -50,-40,-30,-30,-30,-30,-40,-50
-};
+static inline uint64_t northFill(uint64_t b) { b |= b << 8; b |= b << 16; return b | (b << 32); }
+static inline uint64_t southFill(uint64_t b) { b |= b >> 8; b |= b >> 16; return b | (b >> 32); }
+static inline uint64_t sideways(uint64_t b)  { return ((b & ~FILE_H) << 1) | ((b & ~FILE_A) >> 1); }
 
-// Слон: поощряем диагонали/активность
-static const int PST_BISHOP[64] = {
-   -20,-10,-10,-10,-10,-10,-10,-20,
-   -10,  5,  0,  0,  0,  0,  5,-10,
-   -10, 10, 10, 10, 10, 10, 10,-10,
-   -10,  0, 10, 10, 10, 10,  0,-10,
-   -10,  5,  5, 10, 10,  5,  5,-10,
-   -10,  0,  5, 10, 10,  5,  0,-10,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -20,-10,-10,-10,-10,-10,-10,-20
-};
+// вперёд/назад для цвета c; fill — включая исходные клетки
+static inline uint64_t stepUp(uint64_t b, int c)   { return c == 0 ? b << 8 : b >> 8; }
+static inline uint64_t stepDown(uint64_t b, int c) { return c == 0 ? b >> 8 : b << 8; }
+static inline uint64_t fillUp(uint64_t b, int c)   { return c == 0 ? northFill(b) : southFill(b); }
+static inline uint64_t fillDown(uint64_t b, int c) { return c == 0 ? southFill(b) : northFill(b); }
 
-// Ладья: 7-я линия и активность
-static const int PST_ROOK[64] = {
-     0,  0,  5, 10, 10,  5,  0,  0,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-     5, 10, 10, 10, 10, 10, 10,  5,
-     0,  0,  0,  5,  5,  0,  0,  0
+struct PawnEntry {
+    uint64_t key = 0;
+    uint64_t passed[2] = { 0, 0 };   // проходные белых и чёрных
+    int16_t mg = 0, eg = 0;          // за белых
 };
 
-// Ферзь: мягко поощряем активность, но без фанатизма
-static const int PST_QUEEN[64] = {
-   -20,-10,-10, -5, -5,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5,  5,  5,  5,  0,-10,
-    -5,  0,  5,  5,  5,  5,  0, -5,
-     0,  0,  5,  5,  5,  5,  0, -5,
-   -10,  5,  5,  5,  5,  5,  0,-10,
-   -10,  0,  5,  0,  0,  0,  0,-10,
-   -20,-10,-10, -5, -5,-10,-10,-20
-};
+static const int PAWN_TABLE_SIZE = 1 << 14;
+static thread_local PawnEntry pawnTable[PAWN_TABLE_SIZE];
+static thread_local uint64_t pawnProbes = 0, pawnHits = 0;
 
-// Король: в миддлгейме — безопасность (края/рокировка)
-static const int PST_KING_MG[64] = {
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -20,-30,-30,-40,-40,-30,-30,-20,
-   -10,-20,-20,-20,-20,-20,-20,-10,
-    20, 20,  0,  0,  0,  0, 20, 20,
-    20, 30, 10,  0,  0, 10, 30, 20
-};
+static inline uint64_t pawnAttacks(uint64_t pawns, int c) {
+    return c == 0 ? ((pawns & ~FILE_A) << 7) | ((pawns & ~FILE_H) << 9)
+                  : ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
+}
 
-// Король: в эндшпиле — в центр
-static const int PST_KING_EG[64] = {
-   -50,-40,-30,-20,-20,-30,-40,-50,
-   -30,-20,-10,  0,  0,-10,-20,-30,
-   -30,-10, 20, 30, 30, 20,-10,-30,
-   -30,-10, 30, 40, 40, 30,-10,-30,
-   -30,-10, 30, 40, 40, 30,-10,-30,
-   -30,-10, 20, 30, 30, 20,-10,-30,
-   -30,-30,  0,  0,  0,  0,-30,-30,
-   -50,-30,-30,-30,-30,-30,-30,-50
-};
+struct PawnMasks { uint64_t isolated, backward, doubled, passed; };
 
-// Грубая оценка “насколько эндшпиль”
-static int endgamePhase(const Board& b) {
-    // чем меньше тяжёлых фигур — тем ближе к эндшпилю
-    int phase = 0;
-    for (int sqi = 0; sqi < 64; ++sqi) {
-        Piece p = b.sq[sqi];
-        switch (p) {
-            case Piece::WQ: case Piece::BQ: phase += 4; break;
-            case Piece::WR: case Piece::BR: phase += 2; break;
-            case Piece::WB: case Piece::BB: phase += 1; break;
-            case Piece::WN: case Piece::BN: phase += 1; break;
-            default: break;
+static PawnMasks pawnMasks(const uint64_t pawns[2], int c) {
+    PawnMasks m;
+    uint64_t own = pawns[c], their = pawns[c ^ 1];
+
+    m.isolated = own & ~sideways(northFill(southFill(own)));
+
+    // отсталая: все соседние пешки впереди, а поле хода бьёт пешка соперника
+    m.backward = own & ~m.isolated & ~fillUp(sideways(own), c)
+               & stepDown(pawnAttacks(their, c ^ 1), c);
+
+    m.doubled = own & fillUp(stepUp(own, c), c);      // своя позади на вертикали
+
+    // впереди на своей и соседних вертикалях нет чужих, на своей — своих
+    m.passed = own & ~fillDown(stepDown(their | sideways(their), c), c)
+                   & ~fillDown(stepDown(own, c), c);
+    return m;
+}
+
+static void evalPawns(const uint64_t pawns[2], PawnEntry& e) {
+    int mg = 0, eg = 0;
+
+    for (int c = 0; c < 2; ++c) {
+        int sign = c == 0 ? 1 : -1;
+        PawnMasks m = pawnMasks(pawns, c);
+        int isolated = popcount(m.isolated), backward = popcount(m.backward), doubled = popcount(m.doubled);
+
+        mg -= sign * (ISOLATED_MG * isolated + BACKWARD_MG * backward + DOUBLED_MG * doubled);
+        eg -= sign * (ISOLATED_EG * isolated + BACKWARD_EG * backward + DOUBLED_EG * doubled);
+
+        e.passed[c] = m.passed;
+        for (uint64_t bb = m.passed; bb; bb &= bb - 1) {
+            int rank = countr_zero(bb) >> 3;
+            int rel = c == 0 ? rank : 7 - rank;
+            mg += sign * PASSED_MG[rel];
+            eg += sign * PASSED_EG[rel];
         }
     }
-    phase = min(24, phase);
-    int eg = (24 - phase) * 256 / 24;
+
+    e.mg = (int16_t)mg;
+    e.eg = (int16_t)eg;
+}
+
+// короли у проходных — зависит не только от пешек, не кэшируется
+static int passedKingTerm(const uint64_t passed[2], int wk, int bk) {
+    if (wk < 0 || bk < 0) return 0;
+
+    int eg = 0;
+    for (int c = 0; c < 2; ++c)
+        for (uint64_t bb = passed[c]; bb; bb &= bb - 1) {
+            int s = countr_zero(bb);
+            int rel = c == 0 ? (s >> 3) : 7 - (s >> 3);
+            if (rel < 3) continue;
+
+            int stop = c == 0 ? s + 8 : s - 8;
+            int us = c == 0 ? wk : bk, them = c == 0 ? bk : wk;
+            int add = (rel - 2) * (PASSED_KING_THEM * Attacks::DISTANCE[them][stop] - PASSED_KING_US * Attacks::DISTANCE[us][stop]);
+            eg += c == 0 ? add : -add;
+        }
     return eg;
 }
 
+// fill(pawns) — битборды пешек, нужны только при промахе
+template <class Fill>
+static const PawnEntry& probePawns(uint64_t key, Fill fill) {
+    pawnProbes++;
+    PawnEntry& e = pawnTable[key & (PAWN_TABLE_SIZE - 1)];
+
+    if (e.key != key) {
+        uint64_t pawns[2] = { 0, 0 };
+        fill(pawns);
+        evalPawns(pawns, e);
+        e.key = key;
+    } else {
+        pawnHits++;
+    }
+    return e;
+}
+
+static const PawnEntry& probePawns(const Board& b) {
+    return probePawns(b.pawnHash, [&](uint64_t pawns[2]) {
+        for (int sqi = 0; sqi < 64; ++sqi) {
+            if (b.sq[sqi] == Piece::WP) pawns[0] |= 1ULL << sqi;
+            else if (b.sq[sqi] == Piece::BP) pawns[1] |= 1ULL << sqi;
+        }
+    });
+}
+
+// всё, кроме суммы PIECE_SQ: короли и пешки, смешанные по фазе
+static int finish(int base, int phase, int wk, int bk, const PawnEntry& pe) {
+    int egW = EG_WEIGHT[min(24, phase)];
+    int mgW = 256 - egW;
+
+    int s = base;
+    if (wk >= 0) s += kingPst(0, wk, mgW, egW);
+    if (bk >= 0) s += kingPst(1, bk, mgW, egW);
+
+    int eg = pe.eg + passedKingTerm(pe.passed, wk, bk);
+    return s + (pe.mg * mgW + eg * egW) / 256;
+}
+
+// ---- Пакетная оценка ----
+// Сумма PIECE_SQ по клеткам: код фигуры (0..12) — индекс в таблице из 16 байт,
+// поэтому значение берётся через pshufb: младший и старший байт int16 отдельно.
+
+struct ShuffleTables {
+    alignas(16) uint8_t lo[64][16];
+    alignas(16) uint8_t hi[64][16];
+    alignas(16) uint8_t phase[16];
+};
+
+static constexpr ShuffleTables SHUF = [] {
+    ShuffleTables t{};
+    for (int s = 0; s < 64; ++s)
+        for (int pc = 0; pc < 13; ++pc) {
+            uint16_t v = (uint16_t)PIECE_SQ[pc][s];
+            t.lo[s][pc] = (uint8_t)(v & 0xFF);
+            t.hi[s][pc] = (uint8_t)(v >> 8);
+        }
+    for (int pc = 0; pc < 13; ++pc) t.phase[pc] = (uint8_t)PHASE[pc];
+    return t;
+}();
+
+// 32 позиции блока: row(s) = sq + s * stride
+static void sumScalar(const uint8_t* sq, size_t stride, int* base, int* phase) {
+    for (int i = 0; i < 32; ++i) base[i] = phase[i] = 0;
+    for (int s = 0; s < 64; ++s) {
+        const uint8_t* row = sq + s * stride;
+        for (int i = 0; i < 32; ++i) {
+            base[i] += PIECE_SQ[row[i]][s];
+            phase[i] += PHASE[row[i]];
+        }
+    }
+}
+
+#if CPU_X86
+
+TARGET_SSE41
+static void sumSse41(const uint8_t* sq, size_t stride, int* base, int* phase) {
+    const __m128i phaseTbl = _mm_load_si128((const __m128i*)SHUF.phase);
+
+    for (int h = 0; h < 32; h += 16) {
+        __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+        __m128i ph = _mm_setzero_si128();
+
+        for (int s = 0; s < 64; ++s) {
+            __m128i codes = _mm_loadu_si128((const __m128i*)(sq + s * stride + h));
+            __m128i lo = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)SHUF.lo[s]), codes);
+            __m128i hi = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)SHUF.hi[s]), codes);
+            acc0 = _mm_add_epi16(acc0, _mm_unpacklo_epi8(lo, hi));      // позиции 0..7
+            acc1 = _mm_add_epi16(acc1, _mm_unpackhi_epi8(lo, hi));      // 8..15
+            ph = _mm_adds_epu8(ph, _mm_shuffle_epi8(phaseTbl, codes));  // насыщение > 24 не мешает
+        }
+
+        alignas(16) int16_t v[16];
+        alignas(16) uint8_t p[16];
+        _mm_store_si128((__m128i*)v, acc0);
+        _mm_store_si128((__m128i*)(v + 8), acc1);
+        _mm_store_si128((__m128i*)p, ph);
+        for (int i = 0; i < 16; ++i) {
+            base[h + i] = v[i];
+            phase[h + i] = p[i];
+        }
+    }
+}
+
+TARGET_AVX2
+static void sumAvx2(const uint8_t* sq, size_t stride, int* base, int* phase) {
+    const __m256i phaseTbl = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SHUF.phase));
+
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i ph = _mm256_setzero_si256();
+
+    for (int s = 0; s < 64; ++s) {
+        __m256i codes = _mm256_loadu_si256((const __m256i*)(sq + s * stride));
+        __m256i lo = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SHUF.lo[s])), codes);
+        __m256i hi = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SHUF.hi[s])), codes);
+        acc0 = _mm256_add_epi16(acc0, _mm256_unpacklo_epi8(lo, hi));
+        acc1 = _mm256_add_epi16(acc1, _mm256_unpackhi_epi8(lo, hi));
+        ph = _mm256_adds_epu8(ph, _mm256_shuffle_epi8(phaseTbl, codes));
+    }
+
+    // unpack идёт по 128-битным половинам: acc0 — позиции 0..7 и 16..23, acc1 — 8..15 и 24..31
+    alignas(32) int16_t v0[16], v1[16];
+    alignas(32) uint8_t p[32];
+    _mm256_store_si256((__m256i*)v0, acc0);
+    _mm256_store_si256((__m256i*)v1, acc1);
+    _mm256_store_si256((__m256i*)p, ph);
+    for (int i = 0; i < 8; ++i) {
+        base[i] = v0[i];
+        base[16 + i] = v0[8 + i];
+        base[8 + i] = v1[i];
+        base[24 + i] = v1[8 + i];
+    }
+    for (int i = 0; i < 32; ++i) phase[i] = p[i];
+}
+
+#endif // CPU_X86
+
+// ---- Тюнинг ----
+
+// смещения таблиц в сквозной нумерации, порядок — как в paramTables()
+enum : int {
+    P_VALUE = 0,
+    P_PST = P_VALUE + 5,                    // пешка, конь, слон, ладья, ферзь по 64
+    P_KING_MG = P_PST + 5 * 64,
+    P_KING_EG = P_KING_MG + 64,
+    P_PASSED_MG = P_KING_EG + 64,
+    P_PASSED_EG = P_PASSED_MG + 8,
+    P_DOUBLED_MG = P_PASSED_EG + 8, P_DOUBLED_EG,
+    P_ISOLATED_MG, P_ISOLATED_EG,
+    P_BACKWARD_MG, P_BACKWARD_EG,
+    P_PASSED_KING_THEM, P_PASSED_KING_US,
+    P_COUNT
+};
+
+static void addTerm(Eval::Trace& t, int index, int mg, int eg) {
+    if (mg == 0 && eg == 0) return;
+    for (auto& term : t.terms)
+        if (term.index == index) {
+            term.mg = (int16_t)(term.mg + mg);
+            term.eg = (int16_t)(term.eg + eg);
+            return;
+        }
+    t.terms.push_back({ (uint16_t)index, (int16_t)mg, (int16_t)eg });
+}
+
 namespace Eval {
 
+void Batch::reserve(size_t n) {
+    if (n <= capacity) return;
+
+    size_t cap = (n + BLOCK - 1) / BLOCK * BLOCK;
+    vector<uint8_t> grown((size_t)64 * cap, (uint8_t)Piece::Empty);
+    for (int s = 0; s < 64; ++s)
+        copy(squares.begin() + (size_t)s * capacity, squares.begin() + (size_t)s * capacity + count,
+             grown.begin() + (size_t)s * cap);
+
+    squares.swap(grown);
+    for (int c = 0; c < 2; ++c) {
+        pawns[c].resize(cap);
+        kings[c].resize(cap);
+    }
+    pawnKeys.resize(cap);
+    capacity = cap;
+}
+
+void Batch::add(const Board& b) {
+    if (count == capacity) reserve(max(BLOCK, capacity * 2));
+
+    size_t i = count++;
+    pawnKeys[i] = b.pawnHash;
+    pawns[0][i] = pawns[1][i] = 0;
+    kings[0][i] = kings[1][i] = -1;
+
+    for (int s = 0; s < 64; ++s) {
+        Piece p = b.sq[s];
+        squares[(size_t)s * capacity + i] = (uint8_t)p;
+        if (p == Piece::WP) pawns[0][i] |= 1ULL << s;
+        if (p == Piece::BP) pawns[1][i] |= 1ULL << s;
+        if (p == Piece::WK) kings[0][i] = (int8_t)s;
+        if (p == Piece::BK) kings[1][i] = (int8_t)s;
+    }
+}
+
+void Batch::score(int* out, Cpu::Simd simd) const {
+    if ((int)simd > (int)Cpu::best()) simd = Cpu::best();
+
+    // структура пешек — из того же кэша, что у score(); у соседних позиций
+    // (из одной партии) пешки часто совпадают — тогда без обращения к таблице
+    const PawnEntry* pe = nullptr;
+
+    // после clear() в хвосте последнего блока могут остаться старые позиции —
+    // их суммы считаются, но не выводятся
+    for (size_t block = 0; block < count; block += BLOCK) {
+        int base[BLOCK], phase[BLOCK];
+        const uint8_t* sq = squares.data() + block;
+
+#if CPU_X86
+        if (simd == Cpu::Simd::AVX2)       sumAvx2(sq, capacity, base, phase);
+        else if (simd == Cpu::Simd::SSE41) sumSse41(sq, capacity, base, phase);
+        else
+#endif
+            sumScalar(sq, capacity, base, phase);
+
+        size_t n = min(BLOCK, count - block);
+        for (size_t k = 0; k < n; ++k) {
+            size_t i = block + k;
+            if (!pe || pawnKeys[i] != pe->key)
+                pe = &probePawns(pawnKeys[i], [&](uint64_t p[2]) { p[0] = pawns[0][i]; p[1] = pawns[1][i]; });
+            out[i] = finish(base[k], phase[k], kings[0][i], kings[1][i], *pe);
+        }
+    }
+}
+
+
 int score(const Board& b) {
-    int s = 0;
+    int s = 0, phase = 0;
+    int wk = -1, bk = -1;
 
-    int egW = endgamePhase(b);   
-    int mgW = 256 - egW;
+    for (int sqi = 0; sqi < 64; ++sqi) {
+        int pc = (int)b.sq[sqi];
+        s += PIECE_SQ[pc][sqi];
+        phase += PHASE[pc];
+        if (pc == (int)Piece::WK) wk = sqi;
+        if (pc == (int)Piece::BK) bk = sqi;
+    }
+
+    return finish(s, phase, wk, bk, probePawns(b));
+}
+
+PawnHashStats pawnHashStats() {
+    return { pawnProbes, pawnHits };
+}
+
+const vector<ParamTable>& paramTables() {
+    static const vector<ParamTable> tables = {
+        { "PIECE_VALUE", "Материал: пешка, конь, слон, ладья, ферзь", 5, PIECE_VALUE },
+        { "PST_PAWN", "Пешка: поощряем продвижение и центр", 64, PST_PAWN },
+        { "PST_KNIGHT", "Конь: сильный центр, слабые края", 64, PST_KNIGHT },
+        { "PST_BISHOP", "Слон: поощряем диагонали/активность", 64, PST_BISHOP },
+        { "PST_ROOK", "Ладья: 7-я линия и активность", 64, PST_ROOK },
+        { "PST_QUEEN", "Ферзь: мягко поощряем активность, но без фанатизма", 64, PST_QUEEN },
+        { "PST_KING_MG", "Король: в миддлгейме — безопасность (края/рокировка)", 64, PST_KING_MG },
+        { "PST_KING_EG", "Король: в эндшпиле — в центр", 64, PST_KING_EG },
+        { "PASSED_MG", "Проходная по ряду (от своего края), миддлгейм", 8, PASSED_MG },
+        { "PASSED_EG", "Проходная по ряду, эндшпиль", 8, PASSED_EG },
+        { "DOUBLED_MG", "Сдвоенная: за каждую лишнюю на вертикали", 1, &DOUBLED_MG },
+        { "DOUBLED_EG", "", 1, &DOUBLED_EG },
+        { "ISOLATED_MG", "Изолированная", 1, &ISOLATED_MG },
+        { "ISOLATED_EG", "", 1, &ISOLATED_EG },
+        { "BACKWARD_MG", "Отсталая", 1, &BACKWARD_MG },
+        { "BACKWARD_EG", "", 1, &BACKWARD_EG },
+        { "PASSED_KING_THEM", "Проходная в эндшпиле: за каждую клетку от чужого короля до поля хода", 1, &PASSED_KING_THEM },
+        { "PASSED_KING_US", "…и минус за каждую от своего", 1, &PASSED_KING_US },
+    };
+    return tables;
+}
+
+int paramCount() {
+    return P_COUNT;
+}
+
+void trace(const Board& b, Trace& t) {
+    t.terms.clear();
+
+    int base = 0, phase = 0;
+    int wk = -1, bk = -1;
+    uint64_t pawns[2] = { 0, 0 };
 
     for (int sqi = 0; sqi < 64; ++sqi) {
-        Piece p = b.sq[sqi];
-        if (p == Piece::Empty) continue;
+        int pc = (int)b.sq[sqi];
+        if (pc == (int)Piece::Empty) continue;
 
-        bool w = isWhite(p);
-        int idx = w ? sqi : mirror64(sqi); 
-
-        int base = pieceValue(p);
-        int pst = 0;
-
-        switch (p) {
-            case Piece::WP: pst = PST_PAWN[idx]; break;
-            case Piece::BP: pst = PST_PAWN[idx]; break;
-
-            case Piece::WN: case Piece::BN: pst = PST_KNIGHT[idx]; break;
-            case Piece::WB: case Piece::BB: pst = PST_BISHOP[idx]; break;
-            case Piece::WR: case Piece::BR: pst = PST_ROOK[idx]; break;
-            case Piece::WQ: case Piece::BQ: pst = PST_QUEEN[idx]; break;
-
-            case Piece::WK: {
-                int mg = PST_KING_MG[idx];
-                int eg = PST_KING_EG[idx];
-                pst = (mg * mgW + eg * egW) / 256; 
-                break;
-            }
-            case Piece::BK: {
-                int mg = PST_KING_MG[idx];
-                int eg = PST_KING_EG[idx];
-                pst = (mg * mgW + eg * egW) / 256;
-                break;
-            }
-
-            default: break;
+        base += PIECE_SQ[pc][sqi];
+        phase += PHASE[pc];
+
+        Piece p = (Piece)pc;
+        if (p == Piece::WK) wk = sqi;
+        else if (p == Piece::BK) bk = sqi;
+        else {
+            bool w = isWhite(p);
+            int sign = w ? 1 : -1, type = (pc - 1) % 6;
+            addTerm(t, P_VALUE + type, sign, sign);
+            addTerm(t, P_PST + type * 64 + (w ? sqi : mirror64(sqi)), sign, sign);
+            if (p == Piece::WP) pawns[0] |= 1ULL << sqi;
+            if (p == Piece::BP) pawns[1] |= 1ULL << sqi;
+        }
+    }
+
+    if (wk >= 0) {
+        addTerm(t, P_KING_MG + wk, 1, 0);
+        addTerm(t, P_KING_EG + wk, 0, 1);
+    }
+    if (bk >= 0) {
+        addTerm(t, P_KING_MG + mirror64(bk), -1, 0);
+        addTerm(t, P_KING_EG + mirror64(bk), 0, -1);
+    }
+
+    // пешки и короли у проходных — как в evalPawns и passedKingTerm
+    for (int c = 0; c < 2; ++c) {
+        int sign = c == 0 ? 1 : -1;
+        PawnMasks m = pawnMasks(pawns, c);
+
+        addTerm(t, P_ISOLATED_MG, -sign * popcount(m.isolated), 0);
+        addTerm(t, P_ISOLATED_EG, 0, -sign * popcount(m.isolated));
+        addTerm(t, P_BACKWARD_MG, -sign * popcount(m.backward), 0);
+        addTerm(t, P_BACKWARD_EG, 0, -sign * popcount(m.backward));
+        addTerm(t, P_DOUBLED_MG, -sign * popcount(m.doubled), 0);
+        addTerm(t, P_DOUBLED_EG, 0, -sign * popcount(m.doubled));
+
+        for (uint64_t bb = m.passed; bb; bb &= bb - 1) {
+            int s = countr_zero(bb);
+            int rel = c == 0 ? (s >> 3) : 7 - (s >> 3);
+            addTerm(t, P_PASSED_MG + rel, sign, 0);
+            addTerm(t, P_PASSED_EG + rel, 0, sign);
+
+            if (wk < 0 || bk < 0 || rel < 3) continue;
+            int stop = c == 0 ? s + 8 : s - 8;
+            int us = c == 0 ? wk : bk, them = c == 0 ? bk : wk;
+            addTerm(t, P_PASSED_KING_THEM, 0, sign * (rel - 2) * Attacks::DISTANCE[them][stop]);
+            addTerm(t, P_PASSED_KING_US, 0, -sign * (rel - 2) * Attacks::DISTANCE[us][stop]);
         }
+    }
 
-        int add = base + pst;
-        s += w ? add : -add;
+    PawnEntry pe;
+    evalPawns(pawns, pe);
+    t.egW = EG_WEIGHT[min(24, phase)];
+    t.score = finish(base, phase, wk, bk, pe);
+}
+
+void Cache::resize(size_t mb) {
+    size_t n = 0;
+    if (mb > 0) {
+        n = 1;
+        while (n * 2 * sizeof(uint64_t) <= (mb << 20)) n *= 2;
     }
+    table.assign(n, 0);
+    mask = n ? n - 1 : 0;
+    resetStats();
+}
 
-    return s; 
+void Cache::clear() {
+    fill(table.begin(), table.end(), 0);
+    resetStats();
 }
 
-} 
+}
@@ -1,7 +1,110 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include <vector>
 #include "board.h"
+#include "cpu.h"
 
 namespace Eval {
     int score(const Board& b);
+
+    // Пешечная структура (сдвоенные, изолированные, отсталые, проходные)
+    // кэшируется по Board::pawnHash. Таблица и счётчики у каждого потока свои,
+    // счётчики — с его запуска.
+    struct PawnHashStats { uint64_t probes = 0; uint64_t hits = 0; };
+    PawnHashStats pawnHashStats();
+
+    // Пакетная оценка наборов позиций (тюнинг, разметка данных).
+    // Хранение — структура массивов: коды фигур на клетке s у всех позиций
+    // подряд, SIMD считает 32 позиции за шаг. Результат тот же, что у score();
+    // кэш пешек — тот же, у потока свой, разные Batch можно считать в разных потоках.
+    class Batch {
+    public:
+        void reserve(size_t n);
+        void clear() { count = 0; }
+        void add(const Board& b);            // нужен ровно один король каждого цвета
+        size_t size() const { return count; }
+
+        // out[i] — оценка i-й позиции за белых; simd — для проверки ядер
+        void score(int* out, Cpu::Simd simd = Cpu::best()) const;
+
+    private:
+        static const size_t BLOCK = 32;
+
+        size_t count = 0;
+        size_t capacity = 0;                 // кратно BLOCK
+        std::vector<uint8_t> squares;        // [64][capacity], хвост блока — пустые клетки
+        std::vector<uint64_t> pawnKeys;      // Board::pawnHash — ключ кэша пешек
+        std::vector<uint64_t> pawns[2];      // битборды пешек белых и чёрных
+        std::vector<int8_t> kings[2];
+    };
+
+    // ---- Тюнинг ----
+    // Параметры оценки (eval_params.h) списком таблиц. Индекс параметра сквозной:
+    // смещение таблицы в списке + номер значения в ней.
+    struct ParamTable {
+        const char* name;
+        const char* comment;
+        int size;                   // 1 — скаляр
+        const int* values;
+    };
+    const std::vector<ParamTable>& paramTables();
+    int paramCount();
+
+    // Оценка как линейная функция параметров:
+    // score ≈ Σ value[index] * (mg * (256 - egW) + eg * egW) / 256
+    // (точно — до округлений). Без кэшей, можно звать из разных потоков.
+    struct Trace {
+        struct Term { uint16_t index; int16_t mg, eg; };
+        std::vector<Term> terms;    // по одному на параметр, коэффициенты за белых
+        int egW = 0;                // вес эндшпиля из 256
+        int score = 0;              // то же, что score(b)
+    };
+    void trace(const Board& b, Trace& t);
+
+    // Кэш оценок по Board::hash. Запись — 8 байт: старшие 48 бит ключа
+    // для проверки и оценка int16 в младших. Число записей — степень двойки.
+    class Cache {
+    public:
+        explicit Cache(size_t mb = 2) { resize(mb); }
+
+        void resize(size_t mb);              // 0 — кэш выключен
+        void clear();
+        size_t sizeMB() const { return table.size() * sizeof(uint64_t) >> 20; }
+
+        bool probe(uint64_t key, int& s) {
+            if (table.empty()) return false;
+
+            probes++;
+            uint64_t e = table[key & mask];
+            if (((e ^ key) & KEY_MASK) != 0) return false;
+            hits++;
+            s = (int16_t)(uint16_t)e;
+            return true;
+        }
+
+        void store(uint64_t key, int s) {
+            if (table.empty() || s > INT16_MAX || s < INT16_MIN) return;   // не помещается — не храним
+            table[key & mask] = (key & KEY_MASK) | (uint16_t)(int16_t)s;
+        }
+
+        // то же, что Eval::score(b)
+        int score(const Board& b) {
+            int s;
+            if (probe(b.hash, s)) return s;
+            s = Eval::score(b);
+            store(b.hash, s);
+            return s;
+        }
+
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+        void resetStats() { probes = hits = 0; }
+
+    private:
+        static const uint64_t KEY_MASK = ~0xFFFFULL;
+
+        std::vector<uint64_t> table;
+        uint64_t mask = 0;
+    };
 }
@@ -0,0 +1,118 @@
+#pragma once
+
+// Параметры оценки в сантипешках. Таблицы по клеткам — a1..h8 по горизонталям
+// с точки зрения белых, для чёрных отражаются. Файл перезаписывает chess_tuner;
+// набор и порядок параметров — Eval::paramTables().
+namespace EvalParams {
+
+    // Материал: пешка, конь, слон, ладья, ферзь
+    inline constexpr int PIECE_VALUE[5] = { 100, 320, 330, 500, 900 };
+
+    // Пешка: поощряем продвижение и центр
+    inline constexpr int PST_PAWN[64] = {
+           0,    0,    0,    0,    0,    0,    0,    0,
+           5,   10,   10,  -20,  -20,   10,   10,    5,
+           5,   -5,  -10,    0,    0,  -10,   -5,    5,
+           0,    0,    0,   20,   20,    0,    0,    0,
+           5,    5,   10,   25,   25,   10,    5,    5,
+          10,   10,   20,   30,   30,   20,   10,   10,
+          50,   50,   50,   50,   50,   50,   50,   50,
+           0,    0,    0,    0,    0,    0,    0,    0,
+    };
+
+    // Конь: сильный центр, слабые края
+    inline constexpr int PST_KNIGHT[64] = {
+         -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50,
+         -40,  -20,    0,    5,    5,    0,  -20,  -40,
+         -30,    5,   10,   15,   15,   10,    5,  -30,
+         -30,    0,   15,   20,   20,   15,    0,  -30,
+         -30,    5,   15,   20,   20,   15,    5,  -30,
+         -30,    0,   10,   15,   15,   10,    0,  -30,
+         -40,  -20,    0,    0,    0,    0,  -20,  -40,
+         -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50,
+    };
+
+    // Слон: поощряем диагонали/активность
+    inline constexpr int PST_BISHOP[64] = {
+         -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20,
+         -10,    5,    0,    0,    0,    0,    5,  -10,
+         -10,   10,   10,   10,   10,   10,   10,  -10,
+         -10,    0,   10,   10,   10,   10,    0,  -10,
+         -10,    5,    5,   10,   10,    5,    5,  -10,
+         -10,    0,    5,   10,   10,    5,    0,  -10,
+         -10,    0,    0,    0,    0,    0,    0,  -10,
+         -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20,
+    };
+
+    // Ладья: 7-я линия и активность
+    inline constexpr int PST_ROOK[64] = {
+           0,    0,    5,   10,   10,    5,    0,    0,
+          -5,    0,    0,    0,    0,    0,    0,   -5,
+          -5,    0,    0,    0,    0,    0,    0,   -5,
+          -5,    0,    0,    0,    0,    0,    0,   -5,
+          -5,    0,    0,    0,    0,    0,    0,   -5,
+          -5,    0,    0,    0,    0,    0,    0,   -5,
+           5,   10,   10,   10,   10,   10,   10,    5,
+           0,    0,    0,    5,    5,    0,    0,    0,
+    };
+
+    // Ферзь: мягко поощряем активность, но без фанатизма
+    inline constexpr int PST_QUEEN[64] = {
+         -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20,
+         -10,    0,    0,    0,    0,    0,    0,  -10,
+         -10,    0,    5,    5,    5,    5,    0,  -10,
+          -5,    0,    5,    5,    5,    5,    0,   -5,
+           0,    0,    5,    5,    5,    5,    0,   -5,
+         -10,    5,    5,    5,    5,    5,    0,  -10,
+         -10,    0,    5,    0,    0,    0,    0,  -10,
+         -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20,
+    };
+
+    // Король: в миддлгейме — безопасность (края/рокировка)
+    inline constexpr int PST_KING_MG[64] = {
+         -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+         -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+         -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+         -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+         -20,  -30,  -30,  -40,  -40,  -30,  -30,  -20,
+         -10,  -20,  -20,  -20,  -20,  -20,  -20,  -10,
+          20,   20,    0,    0,    0,    0,   20,   20,
+          20,   30,   10,    0,    0,   10,   30,   20,
+    };
+
+    // Король: в эндшпиле — в центр
+    inline constexpr int PST_KING_EG[64] = {
+         -50,  -40,  -30,  -20,  -20,  -30,  -40,  -50,
+         -30,  -20,  -10,    0,    0,  -10,  -20,  -30,
+         -30,  -10,   20,   30,   30,   20,  -10,  -30,
+         -30,  -10,   30,   40,   40,   30,  -10,  -30,
+         -30,  -10,   30,   40,   40,   30,  -10,  -30,
+         -30,  -10,   20,   30,   30,   20,  -10,  -30,
+         -30,  -30,    0,    0,    0,    0,  -30,  -30,
+         -50,  -30,  -30,  -30,  -30,  -30,  -30,  -50,
+    };
+
+    // Проходная по ряду (от своего края), миддлгейм
+    inline constexpr int PASSED_MG[8] = { 0, 5, 10, 15, 25, 40, 60, 0 };
+
+    // Проходная по ряду, эндшпиль
+    inline constexpr int PASSED_EG[8] = { 0, 10, 15, 25, 45, 75, 120, 0 };
+
+    // Сдвоенная: за каждую лишнюю на вертикали
+    inline constexpr int DOUBLED_MG = 10;
+    inline constexpr int DOUBLED_EG = 20;
+
+    // Изолированная
+    inline constexpr int ISOLATED_MG = 10;
+    inline constexpr int ISOLATED_EG = 15;
+
+    // Отсталая
+    inline constexpr int BACKWARD_MG = 8;
+    inline constexpr int BACKWARD_EG = 10;
+
+    // Проходная в эндшпиле: за каждую клетку от чужого короля до поля хода
+    inline constexpr int PASSED_KING_THEM = 5;
+
+    // …и минус за каждую от своего
+    inline constexpr int PASSED_KING_US = 2;
+}
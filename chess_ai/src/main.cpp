@@ -2,11 +2,17 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <optional>
 
 #include "board.h"
 #include "move.h"
 #include "movegen.h"
 #include "search.h"
+#include "ponder.h"
+#include "bench.h"
+#include "book.h"
+#include "bitbase.h"
+#include "nnue.h"
 
 using namespace std;
 
@@ -161,13 +167,72 @@ static bool checkEnd(Board& b) {
     return true;
 }
 
-int main() {
+// NNUE: сеть assets/nnue/net.nnue, если есть
+static bool loadNnue(const string& path) {
+    if (!Nnue::load(path)) return false;
+    Search::setEvaluator(Search::Evaluator::Nnue);
+    cout << "NNUE loaded: " << path << " (" << Nnue::hiddenSize() << " hidden, "
+         << Cpu::name(Nnue::simd()) << ")\n";
+    return true;
+}
+
+// chess_ai bench [depth N] [nodes N] [evalcache MB] [nnue FILE]
+static int runBench(int argc, char** argv) {
+    Bench::Options opt;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string key = argv[i];
+        if (key == "depth")      opt.depth = stoi(argv[i + 1]);
+        else if (key == "nodes") opt.nodes = stoull(argv[i + 1]);
+        else if (key == "evalcache") opt.evalCacheMB = stoi(argv[i + 1]);
+        else if (key == "nnue") {
+            if (!loadNnue(argv[i + 1])) {
+                cerr << "cannot load network " << argv[i + 1] << "\n";
+                return 1;
+            }
+        }
+        else {
+            cerr << "usage: chess_ai bench [depth N] [nodes N] [evalcache MB] [nnue FILE]\n";
+            return 1;
+        }
+    }
+    if (opt.nodes) opt.depth = 64;       // только лимит узлов
+    Bench::run(opt);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc > 1 && string(argv[1]) == "bench")
+        return runBench(argc, argv);
 
     Board b;
     b.setStartPos();
+    Search::newGame();
+
+    PolyglotBook book;                        // assets/book/book.bin
+    for (const char* dir : { "assets/book", "../assets/book", "../../assets/book" }) {
+        if (book.openDir(dir)) {
+            cout << "Book loaded: " << dir << "\n";
+            Search::setBook(&book);
+            break;
+        }
+    }
+
+    for (const char* dir : { "assets/bitbases", "../assets/bitbases", "../../assets/bitbases" }) {
+        if (int n = Bitbase::init(dir)) {
+            cout << "Bitbases loaded: " << n << " from " << dir << "\n";
+            break;
+        }
+    }
+
+    for (const char* path : { "assets/nnue/net.nnue", "../assets/nnue/net.nnue", "../../assets/nnue/net.nnue" })
+        if (loadNnue(path)) break;
 
     bool humanIsWhite = true;
 
+    Ponderer ponder;                          // думаем на времени человека
+    optional<Search::Result> ponderResult;
+
     while (true) {
 
         printGameState(b);
@@ -183,7 +248,7 @@ int main() {
             MoveGen::generateLegalMoves(b, legal);
 
             cout << "Enter move (e2e4, e7e8=Q, O-O, O-O-O)\n";
-            cout << "Type 'moves' or 'quit'\n> ";
+            cout << "Type 'moves', 'analyze', 'eval classic|nnue' or 'quit'\n> ";
 
             string inp;
             getline(cin, inp);
@@ -197,6 +262,37 @@ int main() {
                 continue;
             }
 
+            if (inp == "eval classic" || inp == "eval nnue") {
+                ponder.miss();               // оценщик меняется между поисками
+                bool nnue = inp == "eval nnue";
+                if (Search::setEvaluator(nnue ? Search::Evaluator::Nnue : Search::Evaluator::Classic))
+                    cout << "Evaluation: " << (nnue ? "NNUE" : "classic") << "\n\n";
+                else
+                    cout << "No network loaded\n\n";
+                continue;
+            }
+
+            if (inp == "analyze") {          // лучшие 4 хода позиции
+                ponder.miss();               // поиски идут по очереди
+                Search::Limits al;
+                al.depth = 8;
+                al.time.movetime = 3000;
+                al.multiPV = 4;
+                al.onProgress = [](const Search::Info& i) {
+                    if (!i.iterationDone) return;
+                    cout << "  depth " << i.depth
+                         << " multipv " << i.multipv
+                         << " score " << i.score
+                         << " pv";
+                    for (const auto& m : i.pv) cout << " " << moveToStr(m);
+                    cout << "\n";
+                };
+                Board copy = b;
+                Search::search(copy, al);
+                cout << "\n";
+                continue;
+            }
+
             Move um;
 
             if (!parseUserMove(b, inp, um)) {
@@ -220,6 +316,13 @@ int main() {
                 continue;
             }
 
+            if (ponder.active()) {
+                if (sameMoveIgnoringFlags(chosen, ponder.expected()))
+                    ponderResult = ponder.hit();
+                else
+                    ponder.miss();
+            }
+
             Undo u;
             b.makeMove(chosen, u);
 
@@ -230,8 +333,32 @@ int main() {
             int maxDepth = 6;
             int timeMs   = 800;
 
-            auto r =
-                Search::findBestMoveTimed(b, maxDepth, timeMs);
+            Search::Limits lim;
+            lim.depth = maxDepth;
+            lim.time.movetime = timeMs;
+            lim.useBook = true;
+            lim.onProgress = [](const Search::Info& i) {
+                cout << "  depth " << i.depth << "/" << i.seldepth
+                     << " score " << i.score
+                     << " nodes " << i.nodes
+                     << " nps " << i.nps
+                     << " time " << i.timeMs
+                     << " hashfull " << i.hashfull
+                     << " evalhits " << i.evalHits
+                     << " pv";
+                for (const auto& m : i.pv) cout << " " << moveToStr(m);
+                cout << "\n";
+            };
+
+            Search::Result r;
+            if (ponderResult) {
+                r = *ponderResult;
+                ponderResult.reset();
+                cout << "Ponder hit\n";
+            } else {
+                r = Search::search(b, lim);
+                if (r.fromBook) cout << "Book move\n";
+            }
 
             cout << "AI plays: "
                  << moveToStr(r.best)
@@ -242,6 +369,13 @@ int main() {
 
             Undo u;
             b.makeMove(r.best, u);
+
+            // ожидаемый ответ человека — второй ход PV
+            if (r.pv.size() >= 2) {
+                Search::Limits pl = lim;
+                pl.onProgress = nullptr;
+                ponder.start(b, r.pv[1], pl);
+            }
         }
     }
 
@@ -1,5 +1,5 @@
 // main_gui.cpp  (SFML 3.0.2)
-// GUI: шахматная доска + Unicode-фигуры + подсветка легальных ходов + игра против ИИ (Search::findBestMoveTimed)
+// GUI: шахматная доска + Unicode-фигуры + подсветка легальных ходов + игра против ИИ (Search::search в отдельном потоке)
 
 #include <SFML/Graphics.hpp>
 #include <iostream>
@@ -9,11 +9,17 @@
 #include <filesystem>
 #include <cstdint>
 #include <cmath>
+#include <thread>
+#include <atomic>
 
 #include "board.h"
 #include "move.h"
 #include "movegen.h"
 #include "search.h"
+#include "ponder.h"
+#include "book.h"
+#include "bitbase.h"
+#include "nnue.h"
 
 using namespace std;
 
@@ -52,6 +58,10 @@ static sf::String glyphToSfString(char32_t g) {
 static inline int fileOf(int sq) { return sq & 7; }
 static inline int rankOf(int sq) { return sq >> 3; }
 
+static std::string sqName(int sq) {
+    return std::string() + char('a' + fileOf(sq)) + char('1' + rankOf(sq));
+}
+
 static sf::Vector2f squareTopLeft(int sq, float tile) {
     int f = fileOf(sq);
     int r = rankOf(sq);
@@ -124,12 +134,45 @@ int main() {
 
     Board b;
     b.setStartPos();
+    Search::newGame();
+
+    PolyglotBook book;                         // assets/book/book.bin
+    for (const char* dir : { "assets/book", "../assets/book", "../../assets/book" }) {
+        if (book.openDir(dir)) {
+            std::cout << "Book loaded: " << dir << "\n";
+            Search::setBook(&book);
+            break;
+        }
+    }
+
+    for (const char* dir : { "assets/bitbases", "../assets/bitbases", "../../assets/bitbases" }) {
+        if (int n = Bitbase::init(dir)) {
+            std::cout << "Bitbases loaded: " << n << " from " << dir << "\n";
+            break;
+        }
+    }
+
+    for (const char* path : { "assets/nnue/net.nnue", "../assets/nnue/net.nnue", "../../assets/nnue/net.nnue" }) {
+        if (Nnue::load(path)) {
+            Search::setEvaluator(Search::Evaluator::Nnue);
+            std::cout << "NNUE loaded: " << path << " (" << Cpu::name(Nnue::simd()) << ")\n";
+            break;
+        }
+    }
 
     bool humanIsWhite = true;  
 
     int aiMaxDepth = 7;
     int aiTimeMs   = 800;
 
+    Ponderer ponder;                           // думаем на времени человека
+
+    // ИИ думает в своём потоке, окно при этом перерисовывается
+    std::thread aiThread;
+    Search::Signals aiSignals;
+    std::atomic<bool> aiDone{ false };
+    Search::Result aiResult;
+
     int selectedSq = -1;
     std::vector<Move> legalMovesCache;
     std::vector<Move> selectedMoves; 
@@ -168,6 +211,13 @@ int main() {
             }
         }
 
+        if (ponder.active()) {
+            if (sameMoveBasic(chosen, ponder.expected()))
+                ponder.hitAsync();             // доигрывает в фоне, как обычный ход ИИ
+            else
+                ponder.miss();
+        }
+
         Undo u;
         if (!b.makeMove(chosen, u)) return false;
         return true;
@@ -189,24 +239,73 @@ int main() {
 
     rebuildLegal();
 
+    Search::Limits lim;
+    lim.depth = aiMaxDepth;
+    lim.time.movetime = aiTimeMs;
+    lim.useBook = true;
+    lim.signals = &aiSignals;
+    lim.onProgress = [](const Search::Info& i) {
+        std::cout << "  depth=" << i.depth << "/" << i.seldepth
+                  << " score=" << i.score
+                  << " nodes=" << i.nodes
+                  << " nps=" << i.nps
+                  << " time=" << i.timeMs
+                  << " hashfull=" << i.hashfull
+                  << " evalhits=" << i.evalHits
+                  << " pv=";
+        for (const auto& m : i.pv) std::cout << sqName(m.from) << sqName(m.to) << " ";
+        std::cout << "\n";
+    };
+
+    auto playAiMove = [&](const Search::Result& r) {
+        if (r.fromBook) std::cout << "Book move\n";
+
+        Undo u;
+        b.makeMove(r.best, u);
+
+        if (r.pv.size() >= 2) {
+            Search::Limits pl = lim;
+            pl.onProgress = nullptr;
+            ponder.start(b, r.pv[1], pl);
+        }
+
+        std::cout << "AI: from=" << (int)r.best.from << " to=" << (int)r.best.to
+                  << " score=" << r.score
+                  << " nodes=" << r.nodes
+                  << " depthDone=" << r.depthDone
+                  << " timedOut=" << (r.timedOut ? "YES" : "NO")
+                  << "\n";
+
+        selectedSq = -1;
+        selectedMoves.clear();
+        rebuildLegal();
+    };
+
+    auto stopAi = [&]() {
+        if (!aiThread.joinable()) return;
+        aiSignals.requestStop();
+        aiThread.join();
+    };
+
     while (window.isOpen()) {
-        if (!isHumanTurn()) {
-            if (checkGameEnd()) {
-            } else {
-                auto r = Search::findBestMoveTimed(b, aiMaxDepth, aiTimeMs);
-                Undo u;
-                b.makeMove(r.best, u);
-
-                std::cout << "AI: from=" << (int)r.best.from << " to=" << (int)r.best.to
-                          << " score=" << r.score
-                          << " nodes=" << r.nodes
-                          << " depthDone=" << r.depthDone
-                          << " timedOut=" << (r.timedOut ? "YES" : "NO")
-                          << "\n";
-
-                selectedSq = -1;
-                selectedMoves.clear();
-                rebuildLegal();
+        if (aiThread.joinable() && aiDone) {
+            aiThread.join();
+            playAiMove(aiResult);
+        }
+
+        if (ponder.converting() && ponder.ready()) {
+            std::cout << "Ponder hit\n";
+            playAiMove(ponder.take());
+        }
+
+        if (!isHumanTurn() && !aiThread.joinable() && !ponder.converting()) {
+            if (!checkGameEnd()) {
+                aiSignals.reset();
+                aiDone = false;
+                aiThread = std::thread([&, pos = b]() mutable {
+                    aiResult = Search::search(pos, lim);
+                    aiDone = true;
+                });
             }
         }
 
@@ -217,6 +316,11 @@ int main() {
             const sf::Event& e = *ev;
 
             if (e.is<sf::Event::Closed>()) {
+                // оба поиска (в том числе ponder после hit) останавливаем сразу, потом ждём
+                aiSignals.requestStop();
+                ponder.requestStop();
+                stopAi();
+                ponder.miss();
                 window.close();
             }
 
@@ -340,5 +444,6 @@ int main() {
         window.display();
     }
 
+    stopAi();
     return 0;
 }
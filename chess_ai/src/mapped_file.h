@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Файл, отображённый в память только для чтения (mmap / MapViewOfFile)
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return ptr != nullptr; }
+    const unsigned char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const unsigned char* ptr = nullptr;
+    size_t len = 0;
+    void* fileHandle = nullptr;   // Windows: HANDLE файла и отображения
+    void* mapHandle = nullptr;
+};
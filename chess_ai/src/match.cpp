@@ -0,0 +1,443 @@
+// chess_match: матч двух настроек движка (A — проверяемая, B — базовая)
+// с Elo, доверительным интервалом и SPRT.
+// Запуск: chess_match [ключ значение]... (см. usage)
+//
+// Каждый дебют играется парой партий со сменой цвета. Параллельность — потоками:
+// concurrency потоков берут пары по очереди, у каждого свои Search::State для A
+// и B — TT и история не смешиваются ни между движками, ни между партиями.
+// При вердикте SPRT идущие поиски останавливаются, их партии не считаются.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <array>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+#include "bitbase.h"
+#include "nnue.h"
+
+using namespace std;
+
+struct Engine {
+    vector<pair<string, int>> params;   // Search::setParam
+    bool nnue = false;
+    int evalCacheMB = -1;               // -1 — по умолчанию
+};
+
+struct Options {
+    int games = 1000;                   // округляется вверх до чётного
+    int concurrency = 0;                // 0 — по числу ядер
+    int hashMB = 16;                    // TT каждого движка в каждом потоке
+    string openings;                    // FEN/EPD по строке; пусто — случайные дебюты
+    int randomPlies = 8;                // длина случайного дебюта, полуходов
+    uint64_t seed = 1;
+
+    // контроль: узлы на ход, время на ход или база+добавка (мс)
+    uint64_t nodes = 0;
+    int depth = 64;
+    int64_t movetime = -1;
+    int64_t baseMs = -1;
+    int64_t incMs = 0;
+
+    // адъюдикация (оценки за белых, сантипешки)
+    int resignScore = 1000, resignPlies = 6;     // обе стороны согласны подряд
+    int drawScore = 10, drawPlies = 8, drawMinPly = 80;
+    int maxPly = 400;
+
+    // SPRT: H0 — Elo = elo0, H1 — Elo = elo1
+    double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+
+    string nnueFile, bitbaseDir;
+    int report = 10;                    // строка статистики каждые N партий
+
+    Engine eng[2];
+};
+
+// ---- Дебюты ----
+
+// FEN: первые 4 поля (в EPD дальше идут операции), счётчики обнуляем
+static bool parseOpening(const string& line, string& fen) {
+    istringstream in(line);
+    string f[4];
+    for (auto& s : f)
+        if (!(in >> s)) return false;
+    fen = f[0] + " " + f[1] + " " + f[2] + " " + f[3] + " 0 1";
+    Board b;
+    return b.setFromFEN(fen);
+}
+
+// случайные ходы из начальной позиции; позиция с ходами у обеих сторон
+static Board randomOpening(int plies, uint64_t seed) {
+    mt19937_64 rnd(seed);
+    for (;;) {
+        Board b;
+        b.setStartPos();
+        vector<Move> legal;
+        int i = 0;
+        for (; i < plies; ++i) {
+            MoveGen::generateLegalMoves(b, legal);
+            if (legal.empty()) break;
+            Undo u;
+            b.makeMove(legal[rnd() % legal.size()], u);
+        }
+        MoveGen::generateLegalMoves(b, legal);
+        if (i == plies && !legal.empty()) return b;
+    }
+}
+
+static Board openingFor(const Options& opt, const vector<string>& fens, int pair) {
+    if (fens.empty()) return randomOpening(opt.randomPlies, opt.seed * 1'000'003 + pair);
+    Board b;
+    b.setFromFEN(fens[pair % fens.size()]);
+    return b;
+}
+
+// ---- Партия ----
+
+struct GameResult {
+    double white = 0.5;                 // 1, 0.5, 0 за белых
+    string reason;
+};
+
+static bool insufficientMaterial(const Board& b) {
+    int minors = 0;
+    for (Piece p : b.sq) {
+        switch (p) {
+            case Piece::Empty: case Piece::WK: case Piece::BK: break;
+            case Piece::WN: case Piece::WB: case Piece::BN: case Piece::BB: minors++; break;
+            default: return false;
+        }
+    }
+    return minors <= 1;
+}
+
+// white/black — состояния движков потока; stop — вердикт SPRT, партия не в счёт
+static GameResult playGame(const Options& opt, Board b, Search::State* white, Search::State* black,
+                           Search::Signals& stop) {
+    for (Search::State* e : { white, black }) {
+        Search::selectState(e);
+        Search::newGame();
+    }
+
+    vector<uint64_t> hashes{ b.hash };  // для повторений
+    int64_t clock[2] = { opt.baseMs, opt.baseMs };
+    int resignRun = 0, drawRun = 0;
+    int lastSign = 0;
+
+    for (int ply = 0;; ++ply) {
+        vector<Move> legal;
+        MoveGen::generateLegalMoves(b, legal);
+        bool whiteToMove = b.sideToMove == Color::White;
+
+        if (legal.empty()) {
+            if (b.inCheck(b.sideToMove)) return { whiteToMove ? 0.0 : 1.0, "mate" };
+            return { 0.5, "stalemate" };
+        }
+        if (b.halfmoveClock >= 100) return { 0.5, "50 moves" };
+        if (insufficientMaterial(b)) return { 0.5, "material" };
+
+        int reps = 0;                   // та же позиция среди обратимых ходов
+        for (size_t i = hashes.size(), k = 0; i-- > 0 && k <= b.halfmoveClock; ++k)
+            if (hashes[i] == b.hash) reps++;
+        if (reps >= 3) return { 0.5, "repetition" };
+
+        if (ply >= opt.maxPly) return { 0.5, "max plies" };
+
+        int side = whiteToMove ? 0 : 1;
+        Search::selectState(whiteToMove ? white : black);
+
+        Search::Limits lim;
+        lim.signals = &stop;
+        lim.depth = opt.depth;
+        lim.nodes = opt.nodes;
+        lim.time.movetime = opt.movetime;
+        if (opt.baseMs >= 0) {
+            lim.time.wtime = clock[0];
+            lim.time.btime = clock[1];
+            lim.time.winc = lim.time.binc = opt.incMs;
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        Search::Result r = Search::search(b, lim);
+        if (stop.stop) return { 0.5, "stopped" };
+        int64_t used = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t0).count();
+
+        if (opt.baseMs >= 0) {
+            clock[side] -= used;
+            if (clock[side] < 0) return { whiteToMove ? 0.0 : 1.0, "time forfeit" };
+            clock[side] += opt.incMs;
+        }
+
+        // адъюдикация по оценкам обеих сторон (за белых)
+        int score = whiteToMove ? r.score : -r.score;
+        int sign = (score >= opt.resignScore) ? 1 : (score <= -opt.resignScore) ? -1 : 0;
+        resignRun = (sign != 0 && sign == lastSign) ? resignRun + 1 : (sign != 0);
+        lastSign = sign;
+        if (resignRun >= opt.resignPlies) return { sign > 0 ? 1.0 : 0.0, "adjudication" };
+
+        drawRun = (abs(score) <= opt.drawScore) ? drawRun + 1 : 0;
+        if (drawRun >= opt.drawPlies && ply >= opt.drawMinPly) return { 0.5, "draw adjudication" };
+
+        Undo u;
+        b.makeMove(r.best, u);
+        hashes.push_back(b.hash);
+    }
+}
+
+// настройка текущего состояния потока под движок e
+static bool setupEngine(const Options& opt, int e) {
+    const Engine& eng = opt.eng[e];
+    for (const auto& [name, value] : eng.params) {
+        if (!Search::setParam(name, value)) {
+            cerr << "bad search parameter " << name << "=" << value << "\n";
+            return false;
+        }
+    }
+    if (eng.nnue && !Search::setEvaluator(Search::Evaluator::Nnue)) {
+        cerr << "engine " << char('A' + e) << ": NNUE needs a network (nnue FILE)\n";
+        return false;
+    }
+    if (eng.evalCacheMB >= 0) Search::setEvalCacheSize((size_t)eng.evalCacheMB);
+    return true;
+}
+
+// Поток матча: берёт пары из next, пока они есть и onGame не вернёт false.
+// Результат партии — за A
+template <class F>
+static void playPairs(const Options& opt, const vector<string>& fens, Search::State* const eng[2],
+                      atomic<int>& next, Search::Signals& stop, F onGame) {
+    for (int pair; (pair = next++) * 2 < opt.games;) {
+        Board start = openingFor(opt, fens, pair);
+        for (int k = 0; k < 2; ++k) {
+            GameResult g = playGame(opt, start, eng[k], eng[k ^ 1], stop);  // k = 0: A белыми
+            if (!onGame(pair * 2 + k, k == 0 ? g.white : 1.0 - g.white, g.reason)) return;
+        }
+    }
+}
+
+// ---- Статистика ----
+
+struct Stats {
+    int wins = 0, draws = 0, losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+
+    // дисперсия результата одной партии
+    double variance() const {
+        double s = score(), n = games();
+        return (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / n;
+    }
+
+    // логарифм отношения правдоподобий H1/H0 (нормальное приближение)
+    double llr(double elo0, double elo1) const {
+        if (wins == 0 || losses == 0) return 0.0;   // дисперсия ещё не оценена
+        double s0 = scoreOf(elo0), s1 = scoreOf(elo1);
+        return games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * variance());
+    }
+
+    static double scoreOf(double elo) { return 1.0 / (1.0 + pow(10.0, -elo / 400.0)); }
+    static double eloOf(double s) {
+        if (s == 0.5) return 0.0;
+        s = clamp(s, 1e-6, 1 - 1e-6);
+        return -400.0 * log10(1.0 / s - 1.0);
+    }
+};
+
+static void printStats(const Stats& st, const Options& opt, double lower, double upper) {
+    int n = st.games();
+    double s = st.score();
+    double margin = n > 1 ? 1.96 * sqrt(st.variance() / n) : 0.5;
+    double elo = Stats::eloOf(s);
+    double eloErr = (Stats::eloOf(s + margin) - Stats::eloOf(s - margin)) / 2;
+    double los = (st.wins + st.losses)
+        ? 0.5 * (1 + erf((st.wins - st.losses) / sqrt(2.0 * (st.wins + st.losses)))) : 0.5;
+
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "Games %d: +%d =%d -%d  score %.1f%%  Elo %+.1f +/- %.1f  LOS %.1f%%  LLR %.2f [%.2f, %.2f]",
+             n, st.wins, st.draws, st.losses, 100 * s, elo, eloErr, 100 * los,
+             st.llr(opt.elo0, opt.elo1), lower, upper);
+    cout << buf << endl;
+}
+
+// ---- Параметры командной строки ----
+
+static void usage() {
+    cerr << "usage: chess_match [key value]...\n"
+            "  games N  concurrency N  hash MB  openings FILE  randomplies N  seed N\n"
+            "  nodes N | movetime MS | tc SEC+INC   depth N\n"
+            "  a.eval classic|nnue  b.eval ...  a.evalcache MB  b.evalcache MB  nnue FILE  bitbases DIR\n"
+            "  a.<param> V  b.<param> V          (search parameters, e.g. a.lmrBase 80)\n"
+            "  elo0 E  elo1 E  alpha P  beta P\n"
+            "  resign CP PLIES  draw CP PLIES MINPLY  maxply N  report N\n";
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        string key = argv[i];
+        auto need = [&](int k) { return i + k < argc; };
+        auto next = [&]() { return string(argv[++i]); };
+        if (!need(1)) return false;
+
+        if (key == "games")            opt.games = stoi(next());
+        else if (key == "concurrency") opt.concurrency = stoi(next());
+        else if (key == "hash")        opt.hashMB = stoi(next());
+        else if (key == "openings")    opt.openings = next();
+        else if (key == "randomplies") opt.randomPlies = stoi(next());
+        else if (key == "seed")        opt.seed = stoull(next());
+        else if (key == "nodes")       opt.nodes = stoull(next());
+        else if (key == "depth")       opt.depth = stoi(next());
+        else if (key == "movetime")    opt.movetime = stoll(next());
+        else if (key == "tc") {
+            string tc = next();
+            size_t plus = tc.find('+');
+            opt.baseMs = (int64_t)(stod(tc.substr(0, plus)) * 1000);
+            opt.incMs = plus == string::npos ? 0 : (int64_t)(stod(tc.substr(plus + 1)) * 1000);
+        }
+        else if (key == "nnue")        opt.nnueFile = next();
+        else if (key == "bitbases")    opt.bitbaseDir = next();
+        else if (key == "elo0")        opt.elo0 = stod(next());
+        else if (key == "elo1")        opt.elo1 = stod(next());
+        else if (key == "alpha")       opt.alpha = stod(next());
+        else if (key == "beta")        opt.beta = stod(next());
+        else if (key == "maxply")      opt.maxPly = stoi(next());
+        else if (key == "report")      opt.report = stoi(next());
+        else if (key == "resign" && need(2)) {
+            opt.resignScore = stoi(next());
+            opt.resignPlies = stoi(next());
+        }
+        else if (key == "draw" && need(3)) {
+            opt.drawScore = stoi(next());
+            opt.drawPlies = stoi(next());
+            opt.drawMinPly = stoi(next());
+        }
+        else if (key.size() > 2 && (key[0] == 'a' || key[0] == 'b') && key[1] == '.') {
+            Engine& e = opt.eng[key[0] - 'a'];
+            string name = key.substr(2), value = next();
+            if (name == "eval") {
+                if (value != "classic" && value != "nnue") return false;
+                e.nnue = value == "nnue";
+            }
+            else if (name == "evalcache") e.evalCacheMB = stoi(value);
+            else e.params.push_back({ name, stoi(value) });
+        }
+        else return false;
+    }
+    opt.games += opt.games & 1;
+    return opt.games > 0 && opt.hashMB > 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        if (!parseArgs(argc, argv, opt)) { usage(); return 1; }
+    } catch (const exception&) {
+        usage();
+        return 1;
+    }
+    if (opt.nodes == 0 && opt.movetime < 0 && opt.baseMs < 0 && opt.depth == 64)
+        opt.nodes = 20000;              // по умолчанию — узлы: не зависит от загрузки машины
+    if (opt.concurrency <= 0) opt.concurrency = (int)max(1u, thread::hardware_concurrency());
+    opt.concurrency = min(opt.concurrency, opt.games / 2);
+
+    vector<string> fens;
+    if (!opt.openings.empty()) {
+        ifstream in(opt.openings);
+        if (!in) {
+            cerr << "cannot open " << opt.openings << "\n";
+            return 1;
+        }
+        string line, fen;
+        while (getline(in, line))
+            if (parseOpening(line, fen)) fens.push_back(fen);
+        if (fens.empty()) {
+            cerr << "no openings in " << opt.openings << "\n";
+            return 1;
+        }
+    }
+
+    if (!opt.nnueFile.empty() && !Nnue::load(opt.nnueFile)) {
+        cerr << "cannot load network " << opt.nnueFile << "\n";
+        return 1;
+    }
+    if (!opt.bitbaseDir.empty()) Bitbase::init(opt.bitbaseDir);
+
+    // по паре состояний (A, B) на поток; настраиваем здесь — ошибки до начала матча
+    vector<array<Search::State*, 2>> states(opt.concurrency);
+    bool ok = true;
+    for (auto& st : states)
+        for (int e = 0; e < 2 && ok; ++e) {
+            st[e] = Search::createState();
+            Search::selectState(st[e]);
+            Search::setHashSize((size_t)opt.hashMB);
+            ok = setupEngine(opt, e);
+        }
+    Search::selectState(nullptr);
+    if (!ok) {
+        for (auto& st : states)
+            for (Search::State* e : st) Search::destroyState(e);
+        return 1;
+    }
+
+    cout << "Games: " << opt.games << ", concurrency " << opt.concurrency
+         << ", hash " << opt.hashMB << " MB x " << 2 * opt.concurrency << ", openings: "
+         << (fens.empty() ? to_string(opt.randomPlies) + " random plies" : to_string(fens.size()) + " from " + opt.openings)
+         << "\nSPRT: elo0 " << opt.elo0 << " elo1 " << opt.elo1
+         << " alpha " << opt.alpha << " beta " << opt.beta << endl;
+
+    const double lower = log(opt.beta / (1 - opt.alpha));
+    const double upper = log((1 - opt.beta) / opt.alpha);
+
+    Stats st;
+    mutex statsMutex;
+    bool done = false;
+    atomic<int> nextPair{ 0 };
+    vector<Search::Signals> stops(opt.concurrency);
+    auto t0 = chrono::steady_clock::now();
+
+    // true — продолжать
+    auto onGame = [&](int, double score, const string&) {
+        lock_guard<mutex> lock(statsMutex);
+        if (done) return false;
+        (score > 0.75 ? st.wins : score < 0.25 ? st.losses : st.draws)++;
+
+        double llr = st.llr(opt.elo0, opt.elo1);
+        bool verdict = llr <= lower || llr >= upper;
+        if (st.games() % opt.report == 0 || verdict)
+            printStats(st, opt, lower, upper);
+        if (verdict) {
+            cout << "SPRT: " << (llr >= upper ? "H1 accepted" : "H0 accepted") << endl;
+            done = true;
+            for (auto& s : stops) s.requestStop();   // остальные партии не доигрываем
+        }
+        return !done;
+    };
+
+    vector<thread> workers;
+    for (int w = 0; w < opt.concurrency; ++w)
+        workers.emplace_back([&, w]() {
+            playPairs(opt, fens, states[w].data(), nextPair, stops[w], onGame);
+        });
+    for (auto& t : workers) t.join();
+
+    if (!done && st.games() % opt.report) printStats(st, opt, lower, upper);
+    cout << "Time: " << chrono::duration<double>(chrono::steady_clock::now() - t0).count() << " s" << endl;
+
+    for (auto& s : states)
+        for (Search::State* e : s) Search::destroyState(e);
+    return 0;
+}
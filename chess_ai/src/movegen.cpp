@@ -1,5 +1,7 @@
 #include "movegen.h"
-#include <cstdlib>
+#include "attacks.h"
+#include <bit>
+#include <climits>
 
 using namespace std;
 
@@ -118,21 +120,11 @@ void MoveGen::generateKnightMoves(const Board& b, vector<Move>& out) {
     bool white = (b.sideToMove == Color::White);
     Piece knight = white ? Piece::WN : Piece::BN;
 
-    static const int jumps[8] = { -17, -15, -10, -6, 6, 10, 15, 17 };
-
     for (int from = 0; from < 64; ++from) {
         if (b.sq[from] != knight) continue;
 
-        int f0 = Board::fileOf(from);
-        int r0 = Board::rankOf(from);
-
-        for (int d : jumps) {
-            int to = from + d;
-            if (to < 0 || to >= 64) continue;
-
-            int df = abs(Board::fileOf(to) - f0);
-            int dr = abs(Board::rankOf(to) - r0);
-            if (!((df == 1 && dr == 2) || (df == 2 && dr == 1))) continue;
+        for (uint64_t bb = Attacks::KNIGHT[from]; bb; bb &= bb - 1) {
+            int to = countr_zero(bb);
 
             Piece target = b.sq[to];
             if (target == Piece::Empty) {
@@ -275,27 +267,16 @@ void MoveGen::generateKingMoves(const Board& b, vector<Move>& out) {
     for (int from = 0; from < 64; ++from) {
         if (b.sq[from] != king) continue;
 
-        int f0 = Board::fileOf(from);
-        int r0 = Board::rankOf(from);
-
-        for (int dr = -1; dr <= 1; ++dr) {
-            for (int df = -1; df <= 1; ++df) {
-                if (dr == 0 && df == 0) continue;
-
-                int f = f0 + df;
-                int r = r0 + dr;
-                if (f < 0 || f > 7 || r < 0 || r > 7) continue;
-
-                int to = r * 8 + f;
-                Piece target = b.sq[to];
+        for (uint64_t bb = Attacks::KING[from]; bb; bb &= bb - 1) {
+            int to = countr_zero(bb);
+            Piece target = b.sq[to];
 
-                if (target == Piece::Empty) {
-                    out.push_back(Move{ (uint8_t)from, (uint8_t)to, false, Piece::Empty, false });
-                } else {
-                    bool enemy = white ? isBlackPiece(target) : isWhitePiece(target);
-                    if (enemy) {
-                        out.push_back(Move{ (uint8_t)from, (uint8_t)to, true, Piece::Empty, false });
-                    }
+            if (target == Piece::Empty) {
+                out.push_back(Move{ (uint8_t)from, (uint8_t)to, false, Piece::Empty, false });
+            } else {
+                bool enemy = white ? isBlackPiece(target) : isWhitePiece(target);
+                if (enemy) {
+                    out.push_back(Move{ (uint8_t)from, (uint8_t)to, true, Piece::Empty, false });
                 }
             }
         }
@@ -372,8 +353,43 @@ void MoveGen::generateLegalMoves(Board& b, vector<Move>& out) {
     generateAllPseudoMoves(b, pseudo);
 
     Color us = b.sideToMove;
+    Color them = (us == Color::White) ? Color::Black : Color::White;
+
+    int ks = b.kingSquare(us);
+    bool check = ks >= 0 && b.isSquareAttacked(ks, them);
+    uint64_t occ = b.occupancy();
+
+    // под шахом ход не королём должен взять единственного шахующего
+    // или закрыться на луче между ним и королём
+    uint64_t evasions = ~0ULL;
+    if (check) {
+        uint64_t checkers = 0;
+        for (uint64_t bb = b.attackersTo(ks, occ); bb; bb &= bb - 1) {
+            int c = countr_zero(bb);
+            if (us == Color::White ? isBlackPiece(b.sq[c]) : isWhitePiece(b.sq[c]))
+                checkers |= 1ULL << c;
+        }
+        evasions = popcount(checkers) == 1
+            ? checkers | Attacks::BETWEEN[ks][countr_zero(checkers)]
+            : 0;
+    }
 
     for (const auto& m : pseudo) {
+        if (ks >= 0 && m.from != ks && !m.isEnPassant) {
+            if (!(evasions >> m.to & 1)) continue;
+
+            // Без шаха ход не королём может открыть короля, только если фигура стоит
+            // с ним на одной линии, между ними пусто и она уходит с линии;
+            // en passant снимает две — проверяем ходом
+            if (!check) {
+                uint64_t line = Attacks::LINE[ks][m.from];
+                if (!line || (line >> m.to & 1) || (Attacks::BETWEEN[ks][m.from] & occ)) {
+                    out.push_back(m);
+                    continue;
+                }
+            }
+        }
+
         Undo u;
         if (!b.makeMove(m, u)) continue;
         bool illegal = b.inCheck(us);
@@ -385,3 +401,78 @@ void MoveGen::generateLegalMoves(Board& b, vector<Move>& out) {
         }
     }
 }
+
+// Стоимость фигур по индексу Piece (как у MVV-LVA в поиске)
+static constexpr int PIECE_VALUE[13] = {
+    0, 100, 320, 330, 500, 900, 20000,
+       100, 320, 330, 500, 900, 20000
+};
+
+int MoveGen::pieceValue(Piece p) {
+    return PIECE_VALUE[(int)p];
+}
+
+static Piece capturedPiece(const Board& b, const Move& m) {
+    if (m.isEnPassant)
+        return (b.sideToMove == Color::White) ? Piece::BP : Piece::WP;
+    return b.sq[m.to];
+}
+
+int MoveGen::see(const Board& b, const Move& m) {
+    int gain[32];
+    int d = 0;
+
+    int to = m.to;
+    uint64_t occ = b.occupancy();
+
+    gain[0] = pieceValue(capturedPiece(b, m));
+    Piece onSquare = b.sq[m.from];                       // кто стоит на to после хода
+    if (m.promotion != Piece::Empty) {
+        gain[0] += pieceValue(m.promotion) - 100;
+        onSquare = m.promotion;
+    }
+
+    occ &= ~(1ULL << m.from);
+    if (m.isEnPassant) {
+        int capSq = to + ((b.sideToMove == Color::White) ? -8 : 8);
+        occ &= ~(1ULL << capSq);
+    }
+
+    bool whiteToCapture = (b.sideToMove != Color::White);
+
+    while (d < 31) {
+        uint64_t att = b.attackersTo(to, occ);
+
+        // наименее ценный атакующий нужной стороны
+        int lva = -1;
+        int lvaValue = INT_MAX;
+        for (uint64_t a = att; a; a &= a - 1) {
+            int s = countr_zero(a);
+            Piece p = b.sq[s];
+            if (isWhitePiece(p) != whiteToCapture) continue;
+            int v = pieceValue(p);
+            if (v < lvaValue) { lvaValue = v; lva = s; }
+        }
+        if (lva < 0) break;
+
+        // король не может брать на защищённое поле
+        if (lvaValue == pieceValue(Piece::WK)) {
+            bool defended = false;
+            for (uint64_t a = att & ~(1ULL << lva); a; a &= a - 1)
+                if (isWhitePiece(b.sq[countr_zero(a)]) != whiteToCapture) { defended = true; break; }
+            if (defended) break;
+        }
+
+        d++;
+        gain[d] = pieceValue(onSquare) - gain[d - 1];
+        onSquare = b.sq[lva];
+        occ &= ~(1ULL << lva);
+        whiteToCapture = !whiteToCapture;
+    }
+
+    while (d > 0) {
+        gain[d - 1] = -max(-gain[d - 1], gain[d]);
+        d--;
+    }
+    return gain[0];
+}
@@ -13,4 +13,8 @@ public:
     static void generateKingMoves(const Board& b, std::vector<Move>& out);
     static void generateAllPseudoMoves(const Board& b, std::vector<Move>& out);
     static void generateLegalMoves(Board& b, std::vector<Move>& out);
+
+    // Static Exchange Evaluation: итог серии взятий на m.to (с учётом x-ray)
+    static int see(const Board& b, const Move& m);
+    static int pieceValue(Piece p);       // для SEE и MVV-LVA, король 20000
 };
@@ -0,0 +1,318 @@
+#include "nnue.h"
+#include "mapped_file.h"
+#include "cpu.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const char MAGIC[4] = { 'C', 'N', 'U', 'E' };
+static const uint32_t VERSION = 1;
+static const size_t HEADER_SIZE = 64;
+static const int INPUTS = 768;
+static const int CLIP = 127;               // аккумулятор после clamp влезает в uint8
+
+struct Network {
+    int hidden = 0;
+    int32_t outBias = 0;
+    int32_t scale = 1;
+    int32_t qb = 1;
+    const int16_t* ftWeights = nullptr;    // [768][H]
+    const int16_t* ftBias = nullptr;       // [H]
+    const int8_t* outWeights = nullptr;    // [2H]
+};
+
+static MappedFile netFile;
+static Network net;
+
+// ---- Ядра ----
+// update: dst = src + Σ add - Σ sub (по n элементов int16, с переполнением по модулю)
+// output: Σ clamp(us, 0, 127) * w[0..n) + Σ clamp(them, 0, 127) * w[n..2n)
+
+using UpdateFn = void (*)(int16_t* dst, const int16_t* src,
+                          const int16_t* const* add, int nAdd,
+                          const int16_t* const* sub, int nSub, int n);
+using OutputFn = int32_t (*)(const int16_t* us, const int16_t* them, const int8_t* w, int n);
+
+static void updateScalar(int16_t* dst, const int16_t* src,
+                         const int16_t* const* add, int nAdd,
+                         const int16_t* const* sub, int nSub, int n)
+{
+    if (dst != src) memcpy(dst, src, (size_t)n * sizeof(int16_t));
+    for (int a = 0; a < nAdd; ++a)
+        for (int i = 0; i < n; ++i) dst[i] = (int16_t)(dst[i] + add[a][i]);
+    for (int s = 0; s < nSub; ++s)
+        for (int i = 0; i < n; ++i) dst[i] = (int16_t)(dst[i] - sub[s][i]);
+}
+
+static int32_t outputScalar(const int16_t* us, const int16_t* them, const int8_t* w, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; ++i) sum += clamp<int>(us[i], 0, CLIP) * w[i];
+    for (int i = 0; i < n; ++i) sum += clamp<int>(them[i], 0, CLIP) * w[n + i];
+    return sum;
+}
+
+#if CPU_X86
+
+TARGET_SSE41
+static void updateSse41(int16_t* dst, const int16_t* src,
+                        const int16_t* const* add, int nAdd,
+                        const int16_t* const* sub, int nSub, int n)
+{
+    for (int i = 0; i < n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        for (int a = 0; a < nAdd; ++a)
+            v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i*)(add[a] + i)));
+        for (int s = 0; s < nSub; ++s)
+            v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i*)(sub[s] + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+}
+
+TARGET_SSE41
+static __m128i dotSse41(const int16_t* acc, const int8_t* w, int n, __m128i sum) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i clip = _mm_set1_epi16(CLIP);
+    const __m128i ones = _mm_set1_epi16(1);
+
+    for (int i = 0; i < n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(acc + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(acc + i + 8));
+        a = _mm_min_epi16(_mm_max_epi16(a, zero), clip);
+        b = _mm_min_epi16(_mm_max_epi16(b, zero), clip);
+
+        __m128i u8 = _mm_packus_epi16(a, b);                  // 16 байт 0..127
+        __m128i wv = _mm_loadu_si128((const __m128i*)(w + i));
+        __m128i p16 = _mm_maddubs_epi16(u8, wv);              // пары: |x| <= 2*127*128
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(p16, ones));
+    }
+    return sum;
+}
+
+TARGET_SSE41
+static int32_t outputSse41(const int16_t* us, const int16_t* them, const int8_t* w, int n) {
+    __m128i sum = _mm_setzero_si128();
+    sum = dotSse41(us, w, n, sum);
+    sum = dotSse41(them, w + n, n, sum);
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+TARGET_AVX2
+static void updateAvx2(int16_t* dst, const int16_t* src,
+                       const int16_t* const* add, int nAdd,
+                       const int16_t* const* sub, int nSub, int n)
+{
+    for (int i = 0; i < n; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        for (int a = 0; a < nAdd; ++a)
+            v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i*)(add[a] + i)));
+        for (int s = 0; s < nSub; ++s)
+            v = _mm256_sub_epi16(v, _mm256_loadu_si256((const __m256i*)(sub[s] + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+}
+
+TARGET_AVX2
+static __m256i dotAvx2(const int16_t* acc, const int8_t* w, int n, __m256i sum) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i clip = _mm256_set1_epi16(CLIP);
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    for (int i = 0; i < n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(acc + i + 16));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), clip);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), clip);
+
+        // packus работает по 128-битным половинам: возвращаем порядок байт
+        __m256i u8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        __m256i wv = _mm256_loadu_si256((const __m256i*)(w + i));
+        __m256i p16 = _mm256_maddubs_epi16(u8, wv);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(p16, ones));
+    }
+    return sum;
+}
+
+TARGET_AVX2
+static int32_t outputAvx2(const int16_t* us, const int16_t* them, const int8_t* w, int n) {
+    __m256i sum = _mm256_setzero_si256();
+    sum = dotAvx2(us, w, n, sum);
+    sum = dotAvx2(them, w + n, n, sum);
+
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+
+#endif // CPU_X86
+
+static Cpu::Simd activeSimd = Cpu::Simd::Scalar;
+static UpdateFn updateFn = updateScalar;
+static OutputFn outputFn = outputScalar;
+
+// вход с точки зрения стороны side (0 — белые)
+static inline int feature(int side, Piece p, int sq) {
+    int pc = (int)p;
+    bool white = pc <= (int)Piece::WK;
+    int type = (pc - 1) % 6;
+    bool own = white == (side == 0);
+    return (own ? 0 : 384) + type * 64 + (side == 0 ? sq : sq ^ 56);
+}
+
+static inline const int16_t* weightRow(int f) {
+    return net.ftWeights + (size_t)f * net.hidden;
+}
+
+static int32_t readLE32(const unsigned char* p) {
+    return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+namespace Nnue {
+
+bool load(const string& path) {
+    unload();
+    if (!netFile.open(path) || netFile.size() < HEADER_SIZE) {
+        unload();
+        return false;
+    }
+
+    const unsigned char* p = netFile.data();
+    int32_t hidden = readLE32(p + 8);
+
+    bool ok = equal(MAGIC, MAGIC + 4, p) && (uint32_t)readLE32(p + 4) == VERSION &&
+              hidden > 0 && hidden <= 4096 && hidden % 32 == 0;
+
+    size_t expected = HEADER_SIZE + (size_t)INPUTS * hidden * 2 + (size_t)hidden * 2 + (size_t)hidden * 2;
+    if (!ok || netFile.size() != expected) {
+        unload();
+        return false;
+    }
+
+    net.hidden = hidden;
+    net.outBias = readLE32(p + 12);
+    net.scale = readLE32(p + 16);
+    net.qb = readLE32(p + 20);
+    if (net.qb <= 0) {
+        unload();
+        return false;
+    }
+
+    // веса берём прямо из отображения (данные выровнены: H кратно 32)
+    const unsigned char* w = p + HEADER_SIZE;
+    net.ftWeights = reinterpret_cast<const int16_t*>(w);
+    net.ftBias = net.ftWeights + (size_t)INPUTS * hidden;
+    net.outWeights = reinterpret_cast<const int8_t*>(net.ftBias + hidden);
+
+    setSimd(Cpu::best());
+    return true;
+}
+
+void unload() {
+    netFile.close();
+    net = Network{};
+}
+
+bool isLoaded() {
+    return net.hidden > 0;
+}
+
+int hiddenSize() {
+    return net.hidden;
+}
+
+Cpu::Simd simd() {
+    return activeSimd;
+}
+
+void setSimd(Cpu::Simd s) {
+    if ((int)s > (int)Cpu::best()) s = Cpu::best();
+    activeSimd = s;
+
+    updateFn = updateScalar;
+    outputFn = outputScalar;
+#if CPU_X86
+    if (s == Cpu::Simd::AVX2)  { updateFn = updateAvx2;  outputFn = outputAvx2; }
+    if (s == Cpu::Simd::SSE41) { updateFn = updateSse41; outputFn = outputSse41; }
+#endif
+}
+
+void Stack::reset(const Board& root) {
+    if (hidden != net.hidden) {
+        hidden = net.hidden;
+        storage.assign((size_t)MAX_DEPTH * 2 * hidden + 32, 0);
+        uintptr_t a = reinterpret_cast<uintptr_t>(storage.data());
+        accBase = storage.data() + ((64 - a % 64) % 64) / sizeof(int16_t);
+    }
+
+    top = 0;
+    refresh(root, 0);
+}
+
+void Stack::refresh(const Board& b, int ply) {
+    for (int side = 0; side < 2; ++side) {
+        const int16_t* rows[32];
+        int n = 0;
+        for (int s = 0; s < 64 && n < 32; ++s)
+            if (b.sq[s] != Piece::Empty) rows[n++] = weightRow(feature(side, b.sq[s], s));
+        updateFn(acc(ply, side), net.ftBias, rows, n, nullptr, 0, hidden);
+    }
+    entries[ply].computed = true;
+}
+
+void Stack::push(const Board& after, const Move& m, const Undo& u) {
+    Entry& e = entries[++top];
+    e.computed = false;
+    e.nAdd = e.nSub = 0;
+
+    e.sub[e.nSub++] = { (int8_t)m.from, u.moved };
+    if (u.captured != Piece::Empty)
+        e.sub[e.nSub++] = { u.capturedSquare, u.captured };
+    e.add[e.nAdd++] = { (int8_t)m.to, after.sq[m.to] };      // с учётом превращения
+
+    if (u.wasCastling) {
+        e.sub[e.nSub++] = { u.rookFrom, u.rookPiece };
+        e.add[e.nAdd++] = { u.rookTo, u.rookPiece };
+    }
+}
+
+void Stack::pushNull() {
+    Entry& e = entries[++top];
+    e.computed = false;
+    e.nAdd = e.nSub = 0;
+}
+
+void Stack::update(int ply) {
+    int from = ply;
+    while (!entries[from].computed) from--;           // корень всегда посчитан
+
+    for (int k = from + 1; k <= ply; ++k) {
+        const Entry& e = entries[k];
+        for (int side = 0; side < 2; ++side) {
+            const int16_t* add[2];
+            const int16_t* sub[2];
+            for (int i = 0; i < e.nAdd; ++i) add[i] = weightRow(feature(side, e.add[i].p, e.add[i].sq));
+            for (int i = 0; i < e.nSub; ++i) sub[i] = weightRow(feature(side, e.sub[i].p, e.sub[i].sq));
+            updateFn(acc(k, side), acc(k - 1, side), add, e.nAdd, sub, e.nSub, hidden);
+        }
+        entries[k].computed = true;
+    }
+}
+
+int Stack::evaluate(const Board& b) {
+    if (!entries[top].computed) update(top);
+
+    int us = (b.sideToMove == Color::White) ? 0 : 1;
+    int64_t sum = outputFn(acc(top, us), acc(top, us ^ 1), net.outWeights, hidden);
+    return (int)((sum + net.outBias) * net.scale / (CLIP * net.qb));
+}
+
+}
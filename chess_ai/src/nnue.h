@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "move.h"
+#include "cpu.h"
+
+// Нейросетевая оценка (NNUE): 768 входов (фигура × клетка) → H нейронов
+// на каждую сторону → 1. Первый слой (аккумулятор) не пересчитывается,
+// а обновляется по ходам: в нём меняются 2–4 строки весов.
+//
+// Файл сети (little-endian), читается через mmap:
+//   0  "CNUE", u32 версия = 1, u32 H (кратно 32), i32 смещение выхода,
+//      i32 масштаб (SCALE), i32 QB; до 64 байт — нули
+//   64 i16 веса входов [768][H], i16 смещения [H], i8 веса выхода [2H]
+//      (сначала для стороны на ходу, потом для соперника)
+// Вход с точки зрения стороны c: (фигура своя ? 0 : 384) + тип*64 + клетка,
+// для чёрных клетка зеркалится по вертикали (sq ^ 56).
+// Оценка = (Σ clamp(acc, 0, 127) * w + смещение) * SCALE / (127 * QB).
+namespace Nnue {
+    bool load(const std::string& path);
+    void unload();
+    bool isLoaded();
+    int hiddenSize();
+
+    // при загрузке выбирается Cpu::best();
+    // setSimd — для проверки ядер (не выше поддерживаемого)
+    Cpu::Simd simd();
+    void setSimd(Cpu::Simd s);
+
+    // Аккумуляторы по ply. push — после makeMove, pop — после unmakeMove.
+    // Обновление ленивое: ход только запоминается, а строки весов
+    // применяются при первой оценке в этом узле или ниже.
+    class Stack {
+    public:
+        void reset(const Board& root);      // корень: полный пересчёт
+        void push(const Board& after, const Move& m, const Undo& u);
+        void pushNull();
+        void pop() { top--; }
+
+        int evaluate(const Board& b);       // за сторону на ходу
+
+    private:
+        struct Delta { int8_t sq; Piece p; };
+
+        struct Entry {
+            bool computed = false;
+            int nAdd = 0, nSub = 0;
+            Delta add[2], sub[2];           // изменения относительно родителя
+        };
+
+        int16_t* acc(int ply, int side) { return accBase + ((size_t)ply * 2 + side) * hidden; }
+        void refresh(const Board& b, int ply);
+        void update(int ply);
+
+        static const int MAX_DEPTH = 256;
+
+        Entry entries[MAX_DEPTH];
+        int top = 0;
+
+        int hidden = 0;
+        std::vector<int16_t> storage;       // [ply][сторона][H], выровнено по 64
+        int16_t* accBase = nullptr;
+    };
+}
@@ -0,0 +1,64 @@
+#include "ponder.h"
+
+using namespace std;
+
+Ponderer::~Ponderer() {
+    miss();
+}
+
+void Ponderer::start(const Board& pos, const Move& expected, const Search::Limits& lim) {
+    miss();
+
+    Board b = pos;
+    Undo u;
+    if (!b.makeMove(expected, u)) return;
+
+    signals.reset();
+    expectedMove = expected;
+
+    Search::Limits pl = lim;
+    pl.ponder = true;
+    pl.signals = &signals;
+
+    running = true;
+    converted = false;
+    finished = false;
+
+    // у нового потока своё текущее состояние — берём вызывающего
+    Search::State* state = Search::currentState();
+    worker = thread([this, b, pl, state]() mutable {
+        Search::selectState(state);
+        result = Search::search(b, pl);
+        finished = true;
+    });
+}
+
+Search::Result Ponderer::hit() {
+    hitAsync();
+    return take();
+}
+
+void Ponderer::hitAsync() {
+    if (!active()) return;
+
+    signals.ponderHit();
+    converted = true;
+}
+
+Search::Result Ponderer::take() {
+    if (!running) return Search::Result{};
+
+    worker.join();
+    running = false;
+    converted = false;
+    return result;
+}
+
+void Ponderer::miss() {
+    if (!running) return;
+
+    signals.requestStop();
+    worker.join();
+    running = false;
+    converted = false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include "board.h"
+#include "move.h"
+#include "search.h"
+
+// Поиск на времени соперника: думаем над позицией после ожидаемого ответа
+class Ponderer {
+public:
+    ~Ponderer();
+
+    // запускает фоновый поиск позиции pos + expected с текущим Search::State
+    // вызывающего потока
+    void start(const Board& pos, const Move& expected, const Search::Limits& lim);
+
+    bool active() const { return running && !converted; }   // ждём ход соперника
+    const Move& expected() const { return expectedMove; }
+
+    // соперник сыграл expected: поиск продолжается как обычный, ждём результат
+    Search::Result hit();
+
+    // то же без ожидания (GUI): поиск доигрывает в фоне, результат — take(),
+    // когда ready(); остановить — miss()
+    void hitAsync();
+    bool converting() const { return running && converted; }
+    bool ready() const { return finished; }
+    Search::Result take();                // ждёт, если поиск ещё идёт
+
+    // промах: останавливаем, TT остаётся заполненным
+    void miss();
+
+    // сигнал остановки без ожидания (и после hitAsync); дождаться — miss()
+    void requestStop() { if (running) signals.requestStop(); }
+
+private:
+    std::thread worker;
+    Search::Signals signals;
+    Search::Result result;
+    Move expectedMove;
+    bool running = false;
+    bool converted = false;               // был hit, идёт обычный поиск
+    std::atomic<bool> finished{ false };
+};
@@ -2,32 +2,42 @@
 #include "search.h"
 #include "movegen.h"
 #include "eval.h"
+#include "timeman.h"
+#include "book.h"
+#include "bitbase.h"
+#include "nnue.h"
 
 #include <vector>
+#include <array>
 #include <limits>
 #include <algorithm>
 #include <utility>
 #include <chrono>
 #include <cstring>  
+#include <cmath>
+#include <bit>
+#include <mutex>
 
 using namespace std;
 
 static const int INF  = 1'000'000'000;
 static const int MATE = 1'000'000;
+static const int TB_WIN = 500'000;      // выигрыш по битбазе: ниже любого мата
 
 static inline bool isMateScore(int s) {
     return (s > MATE - 10000) || (s < -MATE + 10000);
 }
 
+// маты и выигрыши по битбазе хранятся в TT относительно узла
 static inline int toTTScore(int s, int ply) {
-    if (s > MATE - 10000) return s + ply;
-    if (s < -MATE + 10000) return s - ply;
+    if (s > TB_WIN - 10000) return s + ply;
+    if (s < -TB_WIN + 10000) return s - ply;
     return s;
 }
 
 static inline int fromTTScore(int s, int ply) {
-    if (s > MATE - 10000) return s - ply;
-    if (s < -MATE + 10000) return s + ply;
+    if (s > TB_WIN - 10000) return s - ply;
+    if (s < -TB_WIN + 10000) return s + ply;
     return s;
 }
 
@@ -39,13 +49,70 @@ struct TTEntry {
     int score = 0;
     TTFlag flag = TT_EXACT;
     Move best;
+    uint8_t gen = 0;                    // поколение (номер поиска)
 };
 
-static const int TT_SIZE = 1 << 20;
-static TTEntry TT[TT_SIZE];
+static const size_t TT_DEFAULT_MB = 32;     // 1 << 20 записей
+static const size_t TT_MIN_ENTRIES = 1024; // hashfull смотрит первые 1000
+static const int LMR_MAX = 64;
+static const int MAX_PLY = 128;
+
+// Ход на каждом ply текущей ветки (для countermove и continuation history)
+struct StackEntry {
+    Piece piece = Piece::Empty;         // Empty — null move / нет хода
+    uint8_t to = 0;
+};
+
+// Всё, что живёт между поисками (TT, история, кэш оценок, параметры),
+// и рабочие массивы самого поиска. Обычно одно на процесс; в матче у каждого
+// движка своё, и партии в разных потоках не мешают друг другу.
+struct Search::State {
+    State() { resizeTT(TT_DEFAULT_MB); }
+
+    mutex busy;                              // один поиск на состояние за раз
+
+    vector<TTEntry> tt;
+    size_t ttMask = 0;
+    void resizeTT(size_t mb);
+    uint8_t ttGeneration = 0;
+
+    Eval::Cache evalCache;                   // оценки по ключу позиции (за белых)
+    Search::Evaluator evaluator = Search::Evaluator::Classic;
+
+    Search::Params params;
+    int lmrTable[LMR_MAX][LMR_MAX] = {};     // [глубина][номер хода], по params
+    bool lmrInit = false;
+
+    int16_t historyTable[2][64][64] = {};           // [сторона][откуда][куда]
+    Move counterMoves[13][64];                      // [фигура][поле] прошлого хода
+    int16_t contHistory[2][13][64][13][64] = {};    // [1/2 полухода назад][пред.][текущий]
+    int16_t captureHistory[13][64][13] = {};        // [фигура][поле][взятая фигура]
+
+    PolyglotBook* book = nullptr;
+
+    // рабочие массивы поиска, по ply текущей ветки
+    Move killers[MAX_PLY][2];
+    Move pvTable[MAX_PLY][MAX_PLY];          // треугольная PV таблица
+    int  pvLen[MAX_PLY] = {};                // конец PV для каждого ply
+    StackEntry moveStack[MAX_PLY];
+    bool nnueOn = false;                     // в этом поиске оценивает NNUE
+    Nnue::Stack nnueStack;                   // аккумуляторы NNUE
+};
+
+// степень двойки записей, не больше mb мегабайт (но не меньше TT_MIN_ENTRIES)
+void Search::State::resizeTT(size_t mb) {
+    size_t n = TT_MIN_ENTRIES;
+    while (n * 2 * sizeof(TTEntry) <= (mb << 20)) n *= 2;
+    tt = vector<TTEntry>(n);                 // assign не отдал бы лишнюю память
+    ttMask = n - 1;
+    ttGeneration = 0;
+}
+
+static Search::State defaultState;
+static thread_local Search::State* S = &defaultState;   // текущее у потока, меняется selectState
 
 static inline TTEntry* probeTT(uint64_t key) {
-    return &TT[key & (TT_SIZE - 1)];
+    return &S->tt[key & S->ttMask];
 }
 
 static inline void storeTT(uint64_t key, int depth, int score,
@@ -53,28 +120,133 @@ static inline void storeTT(uint64_t key, int depth, int score,
 {
     TTEntry* e = probeTT(key);
 
-    if (depth >= e->depth) {
+    // записи прошлых поисков вытесняются независимо от глубины
+    if (depth >= e->depth || e->gen != S->ttGeneration || e->key == key) {
         e->key = key;
         e->depth = depth;
         e->score = score;
         e->flag = flag;
         e->best = best;
+        e->gen = S->ttGeneration;
     }
 }
 
+static int hashfull() {
+    int used = 0;
+    for (int i = 0; i < 1000; ++i)
+        if (S->tt[i].depth >= 0 && S->tt[i].gen == S->ttGeneration) used++;
+    return used;                                   // промилле
+}
+
 struct SearchState {
     chrono::steady_clock::time_point deadline; // дедлайн времени
     bool stop = false;                         // флаг стоп
+    uint64_t maxNodes = 0;                     // 0 — без лимита
+    int seldepth = 0;                          // макс. достигнутый ply
+
+    // отчёты о прогрессе
+    const Search::ProgressFn* progress = nullptr;
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::duration reportEvery{};
+    chrono::steady_clock::time_point nextReport;
+    Search::Info last;                         // последняя завершённая итерация
+
+    int tbPieces = 0;                          // пробуем битбазы при стольких фигурах, 0 — нет
+
+    vector<Move> prevPV;                       // PV прошлой итерации
+    bool followPV = false;                     // узел лежит на prevPV
+
+    // внешние сигналы и ponder
+    Search::Signals* signals = nullptr;
+    const atomic<bool>* stopFlag = nullptr;    // signals->stop, проверяется в каждом узле
+    bool pondering = false;
+    TimeMan::Manager* tm = nullptr;
+    const TimeMan::Control* tc = nullptr;
+    Color side = Color::White;
 };
 
-static inline bool timeUp(const SearchState& st) {
-    return chrono::steady_clock::now() >= st.deadline; // проверка времени
+static Search::Info makeInfo(const SearchState& st, uint64_t nodes,
+                             chrono::steady_clock::time_point now)
+{
+    Search::Info info = st.last;
+    info.seldepth = st.seldepth;
+    info.nodes = nodes;
+    int64_t us = chrono::duration_cast<chrono::microseconds>(now - st.start).count();
+    info.timeMs = us / 1000;
+    info.nps = us > 0 ? nodes * 1'000'000 / (uint64_t)us : 0;
+    info.hashfull = hashfull();
+    info.evalHits = S->evalCache.probes ? (int)(S->evalCache.hits * 1000 / S->evalCache.probes) : 0;
+    return info;
 }
 
-static const int MAX_PLY = 128;
+static void pollClock(SearchState& st, uint64_t nodes) {
+    if (st.maxNodes && nodes >= st.maxNodes) { st.stop = true; return; }
+
+    if (st.signals) {
+        if (st.signals->stop.load(memory_order_relaxed)) { st.stop = true; return; }
+
+        // ponderhit: с этого момента пошли наши часы
+        if (st.pondering && st.signals->ponderhit.load(memory_order_relaxed)) {
+            st.pondering = false;
+            st.tm->start(*st.tc, st.side);
+            st.deadline = st.tm->deadline();
+        }
+    }
+
+    auto now = chrono::steady_clock::now();
+    if (now >= st.deadline) { st.stop = true; return; }   // проверка времени
+
+    if (st.progress && st.reportEvery.count() > 0 && now >= st.nextReport) {
+        st.nextReport = now + st.reportEvery;
+        Search::Info info = makeInfo(st, nodes, now);
+        info.iterationDone = false;
+        (*st.progress)(info);
+    }
+}
 
-static Move killers[MAX_PLY][2];        // killer ходы
-static int  historyTable[2][64][64];    // history таблица
+static const uint64_t TIME_CHECK_MASK = 1023;   // часы опрашиваем раз в 1024 узла
+
+static inline bool shouldStop(SearchState& st, uint64_t nodes) {
+    if (st.stop) return true;
+
+    // внешний stop и лимит узлов — в каждом узле, это одна загрузка
+    if ((st.stopFlag && st.stopFlag->load(memory_order_relaxed)) ||
+        (st.maxNodes && nodes >= st.maxNodes))
+    {
+        st.stop = true;
+        return true;
+    }
+
+    if ((nodes & TIME_CHECK_MASK) == 0) pollClock(st, nodes);
+    return st.stop;
+}
+
+static void initLmr() {
+    const Search::Params& P = S->params;
+    for (int d = 0; d < LMR_MAX; ++d)
+        for (int n = 0; n < LMR_MAX; ++n) {
+            if (d == 0 || n == 0) { S->lmrTable[d][n] = 0; continue; }
+            double r = P.lmrBase / 100.0 + log((double)d) * log((double)n) * 100.0 / P.lmrDiv;
+            S->lmrTable[d][n] = max(0, (int)r);
+        }
+    S->lmrInit = true;
+}
+
+static inline int lmrReduction(int depth, int moveNum) {
+    return S->lmrTable[min(depth, LMR_MAX - 1)][min(moveNum, LMR_MAX - 1)];
+}
+
+// History с "гравитацией": значения насыщаются у +-HIST_MAX
+static const int HIST_MAX       = 16384;
+static const int HIST_BONUS_MAX = 1600;
+
+static inline int historyBonus(int depth) {
+    return min(16 * depth * depth, HIST_BONUS_MAX);
+}
+
+static inline void applyGravity(int16_t& h, int bonus) {
+    h = (int16_t)(h + bonus - h * abs(bonus) / HIST_MAX);
+}
 
 static inline int sideIndex(Color c) { return (c == Color::White) ? 0 : 1; }
 
@@ -93,35 +265,162 @@ static inline bool isQuiet(const Move& m) {
 }
 
 static inline void clearHeuristics() {
-    memset(killers, 0, sizeof(killers));       // очистка killers
-    memset(historyTable, 0, sizeof(historyTable)); // очистка history
-}
-static int absPieceValue(Piece p) {
-    switch (p) {
-        case Piece::WP: case Piece::BP: return 100;
-        case Piece::WN: case Piece::BN: return 320;
-        case Piece::WB: case Piece::BB: return 330;
-        case Piece::WR: case Piece::BR: return 500;
-        case Piece::WQ: case Piece::BQ: return 900;
-        case Piece::WK: case Piece::BK: return 20000;
-        default: return 0;
+    memset(S->killers, 0, sizeof(S->killers));       // очистка killers
+    memset(S->historyTable, 0, sizeof(S->historyTable)); // очистка history
+    memset(S->counterMoves, 0, sizeof(S->counterMoves));
+    memset(S->contHistory, 0, sizeof(S->contHistory));
+    memset(S->captureHistory, 0, sizeof(S->captureHistory));
+    for (auto& e : S->moveStack) e = StackEntry{};
+}
+
+// Начало нового хода: history ослабляем, а не обнуляем; TT стареет
+static const int HISTORY_AGE_SHIFT = 1;    // делим на 2
+
+static inline void ageTable(int16_t* t, size_t n) {
+    for (size_t i = 0; i < n; ++i) t[i] = (int16_t)(t[i] >> HISTORY_AGE_SHIFT);
+}
+
+// ageHistory = false для ponder: он думает над тем же ходом партии, что и
+// следующий поиск, — история ослабляется один раз на ход, с ponder и без
+static void newSearch(const Board& root, bool ageHistory = true) {
+    memset(S->killers, 0, sizeof(S->killers));       // killers привязаны к ply — не переносим
+    for (auto& e : S->moveStack) e = StackEntry{};
+
+    if (ageHistory) {
+        ageTable(&S->historyTable[0][0][0], sizeof(S->historyTable) / sizeof(int16_t));
+        ageTable(&S->contHistory[0][0][0][0][0], sizeof(S->contHistory) / sizeof(int16_t));
+        ageTable(&S->captureHistory[0][0][0], sizeof(S->captureHistory) / sizeof(int16_t));
+    }
+
+    S->ttGeneration++;
+    S->evalCache.resetStats();
+
+    S->nnueOn = S->evaluator == Search::Evaluator::Nnue && Nnue::isLoaded();
+    if (S->nnueOn) S->nnueStack.reset(root);
+}
+// Стоимость фигур по индексу Piece
+static constexpr int PIECE_VALUE[13] = {
+    0, 100, 320, 330, 500, 900, 20000,
+       100, 320, 330, 500, 900, 20000
+};
+
+static inline int absPieceValue(Piece p) { return PIECE_VALUE[(int)p]; }
+
+// MVV-LVA: [жертва][атакующий]
+static constexpr auto MVV_LVA = [] {
+    array<array<int, 13>, 13> t{};
+    for (int v = 0; v < 13; ++v)
+        for (int a = 0; a < 13; ++a)
+            t[v][a] = 10 * PIECE_VALUE[v] - PIECE_VALUE[a];
+    return t;
+}();
+
+// Есть ли у стороны фигуры кроме пешек и короля (защита от цугцванга)
+static int pieceCount(const Board& b) {
+    int n = 0;
+    for (Piece p : b.sq) n += (p != Piece::Empty);
+    return n;
+}
+
+static bool hasNonPawnMaterial(const Board& b, Color side) {
+    Piece lo = (side == Color::White) ? Piece::WN : Piece::BN;
+    Piece hi = (side == Color::White) ? Piece::WQ : Piece::BQ;
+    for (int i = 0; i < 64; ++i) {
+        Piece p = b.sq[i];
+        if (p >= lo && p <= hi) return true;
     }
+    return false;
 }
 
-static int promoValue(Piece p) {
-    switch (p) {
-        case Piece::WQ: case Piece::BQ: return 900;
-        case Piece::WR: case Piece::BR: return 500;
-        case Piece::WB: case Piece::BB: return 330;
-        case Piece::WN: case Piece::BN: return 320;
-        default: return 0;
+static inline int evalSide(const Board& b) {
+    bool white = (b.sideToMove == Color::White);
+
+    if (S->nnueOn) {
+        int s;
+        if (S->evalCache.probe(b.hash, s)) return white ? s : -s;
+        s = S->nnueStack.evaluate(b);                    // NNUE считает за ходящего
+        S->evalCache.store(b.hash, white ? s : -s);
+        return s;
     }
+
+    int s = S->evalCache.score(b);
+    return white ? s : -s;                            // оценка за ходящего
+}
+
+// ходы в дереве: вместе с доской двигается стек аккумуляторов NNUE
+static inline bool doMove(Board& b, const Move& m, Undo& u) {
+    if (!b.makeMove(m, u)) return false;
+    if (S->nnueOn) S->nnueStack.push(b, m, u);
+    return true;
 }
 
+static inline void undoMove(Board& b, const Move& m, const Undo& u) {
+    b.unmakeMove(m, u);
+    if (S->nnueOn) S->nnueStack.pop();
+}
+
+static inline void doNullMove(Board& b, Undo& u) {
+    b.makeNullMove(u);
+    if (S->nnueOn) S->nnueStack.pushNull();
+}
+
+static inline void undoNullMove(Board& b, const Undo& u) {
+    b.unmakeNullMove(u);
+    if (S->nnueOn) S->nnueStack.pop();
+}
+
+static inline Piece capturedPiece(const Board& b, const Move& m) {
+    if (m.isEnPassant)
+        return (b.sideToMove == Color::White) ? Piece::BP : Piece::WP;
+    return b.sq[m.to];
+}
+
+
 static bool isTactical(const Move& m) {
     return m.isCapture || m.isEnPassant || (m.promotion != Piece::Empty); 
 }
 
+// ход k полуходов назад от узла на ply
+static inline const StackEntry* prevMove(int ply, int k) {
+    if (ply - k < 0) return nullptr;
+    const StackEntry* e = &S->moveStack[ply - k];
+    return (e->piece == Piece::Empty) ? nullptr : e;
+}
+
+// butterfly + continuation history для тихого хода
+static int quietHistory(const Board& b, const Move& m, int ply) {
+    int pc = (int)b.sq[m.from];
+    int h = S->historyTable[sideIndex(b.sideToMove)][m.from][m.to];
+
+    for (int k = 1; k <= 2; ++k)
+        if (const StackEntry* e = prevMove(ply, k))
+            h += S->contHistory[k - 1][(int)e->piece][e->to][pc][m.to];
+
+    return h;
+}
+
+static void updateQuietHistory(const Board& b, const Move& m, int ply, int bonus) {
+    int pc = (int)b.sq[m.from];
+    applyGravity(S->historyTable[sideIndex(b.sideToMove)][m.from][m.to], bonus);
+
+    for (int k = 1; k <= 2; ++k)
+        if (const StackEntry* e = prevMove(ply, k))
+            applyGravity(S->contHistory[k - 1][(int)e->piece][e->to][pc][m.to], bonus);
+}
+
+static inline int16_t& captureHist(const Board& b, const Move& m) {
+    return S->captureHistory[(int)b.sq[m.from]][m.to][(int)capturedPiece(b, m)];
+}
+
+static inline bool isCounterMove(const Move& m, int ply) {
+    const StackEntry* e = prevMove(ply, 1);
+    return e && sameMoveFull(m, S->counterMoves[(int)e->piece][e->to]);
+}
+
+static const int KILLER_SCORE  = 800'000;
+static const int COUNTER_SCORE = 780'000;
+static const int CAPTURE_HIST_DIV = 8;  // capture history в масштабе MVV-LVA
+
 static int moveScore(Board& b, const Move& m, const Move* ttMove, int ply) {
 
     if (ttMove && sameMoveFull(m, *ttMove))
@@ -131,63 +430,77 @@ static int moveScore(Board& b, const Move& m, const Move* ttMove, int ply) {
 
     if (m.promotion != Piece::Empty) {
         s += 1'000'000;              // приоритет промоции
-        s += promoValue(m.promotion);
+        s += absPieceValue(m.promotion);
     }
 
     if (m.isCapture || m.isEnPassant) {
-        s += 900'000;                // приоритет взятия
+        Piece victim = capturedPiece(b, m);
+        Piece attacker = b.sq[m.from];
 
-        Piece victim = Piece::Empty;
-        if (m.isEnPassant)
-            victim = (b.sideToMove == Color::White) ? Piece::BP : Piece::WP;
-        else
-            victim = b.sq[m.to];
+        // SEE нужен только когда атакующий дороже жертвы
+        bool good = absPieceValue(attacker) <= absPieceValue(victim) || MoveGen::see(b, m) >= 0;
 
-        Piece attacker = b.sq[m.from];
-        s += 10 * absPieceValue(victim) - absPieceValue(attacker); 
+        s += good ? 900'000 : -1'000'000;   // плохие взятия — после тихих
+        s += MVV_LVA[(int)victim][(int)attacker];
+        s += captureHist(b, m) / CAPTURE_HIST_DIV;
         return s;
     }
 
-    // killer ходы
+    // killer ходы и countermove
     if (isQuiet(m) && ply < MAX_PLY) {
-        if (sameMoveFull(m, killers[ply][0])) return 800'000;
-        if (sameMoveFull(m, killers[ply][1])) return 790'000;
+        if (sameMoveFull(m, S->killers[ply][0])) return KILLER_SCORE;
+        if (sameMoveFull(m, S->killers[ply][1])) return KILLER_SCORE - 10'000;
+        if (isCounterMove(m, ply)) return COUNTER_SCORE;
     }
 
     // history
-    if (isQuiet(m)) {
-        int si = sideIndex(b.sideToMove);
-        s += historyTable[si][m.from][m.to];
-    }
+    if (isQuiet(m))
+        s += quietHistory(b, m, ply);
 
     return s;
 }
 
-static void orderMoves(Board& b, vector<Move>& moves, const Move* ttMove, int ply) {
-    vector<pair<int, Move>> scored;
-    scored.reserve(moves.size());
+static const int MAX_MOVES = 256;
+
+// Оценки ходов в параллельный массив, без сортировки
+static void scoreMoves(Board& b, const vector<Move>& moves, int* scores,
+                       const Move* ttMove, int ply)
+{
+    for (size_t i = 0; i < moves.size(); ++i)
+        scores[i] = moveScore(b, moves[i], ttMove, ply);
+}
 
-    for (const auto& m : moves)
-        scored.push_back({ moveScore(b, m, ttMove, ply), m });
+// Ленивый выбор: лучший из оставшихся ставится на место i
+static inline int pickNext(vector<Move>& moves, int* scores, size_t i) {
+    size_t best = i;
+    for (size_t j = i + 1; j < moves.size(); ++j)
+        if (scores[j] > scores[best]) best = j;
 
-    stable_sort(scored.begin(), scored.end(),
-        [](const pair<int, Move>& a, const pair<int, Move>& b) {
-            return a.first > b.first;
-        });
+    if (best != i) {
+        swap(moves[i], moves[best]);
+        swap(scores[i], scores[best]);
+    }
+    return scores[i];
+}
 
-    for (size_t i = 0; i < moves.size(); ++i)
-        moves[i] = scored[i].second;
+static inline void updatePV(int ply, const Move& m) {
+    S->pvTable[ply][ply] = m;
+    for (int i = ply + 1; i < S->pvLen[ply + 1]; ++i)
+        S->pvTable[ply][i] = S->pvTable[ply + 1][i];
+    S->pvLen[ply] = max(S->pvLen[ply + 1], ply + 1);
 }
 
 static int quiescence(Board& b, int alpha, int beta, int ply,
                       uint64_t& nodes, SearchState& st)
 {
+    const Search::Params& P = S->params;
+    S->pvLen[ply] = ply;
+    if (shouldStop(st, nodes)) return 0;   // проверка таймера и лимитов
     nodes++;                               // счет узлов
-    if (st.stop) return 0;
-    if (timeUp(st)) { st.stop = true; return 0; } // проверка таймера
+    if (ply > st.seldepth) st.seldepth = ply;
+    if (ply >= MAX_PLY - 1) return evalSide(b);
 
-    int stand = Eval::score(b);             // стат оценка
-    stand = (b.sideToMove == Color::White) ? stand : -stand;
+    int stand = evalSide(b);                // стат оценка
 
     if (stand >= beta) return beta;         // beta отсечение
     if (stand > alpha) alpha = stand;       // alpha обновление
@@ -199,16 +512,28 @@ static int quiescence(Board& b, int alpha, int beta, int ply,
     for (const auto& m : pseudo)
         if (isTactical(m)) tact.push_back(m);   // только тактика
 
-    orderMoves(b, tact, nullptr, ply);
+    int scores[MAX_MOVES];
+    scoreMoves(b, tact, scores, nullptr, ply);
 
-    for (const auto& m : tact) {
+    for (size_t i = 0; i < tact.size(); ++i) {
+
+        int ms = pickNext(tact, scores, i);
+        const Move& m = tact[i];
+
+        // дальше только проигрышные по SEE взятия
+        if (P.qsSeePrune && ms < 0) break;
+
+        // delta: даже взятие не дотягивает до alpha
+        if (P.qsDeltaEnabled && m.promotion == Piece::Empty &&
+            stand + absPieceValue(capturedPiece(b, m)) + P.qsDeltaMargin <= alpha)
+            continue;
 
         Undo u;
-        if (!b.makeMove(m, u)) continue;
+        if (!doMove(b, m, u)) continue;
 
         int score = -quiescence(b, -beta, -alpha, ply + 1, nodes, st);
 
-        b.unmakeMove(m, u);
+        undoMove(b, m, u);
 
         if (score >= beta) return beta;     // отсечение
         if (score > alpha) alpha = score;   // лучший
@@ -218,13 +543,20 @@ static int quiescence(Board& b, int alpha, int beta, int ply,
 }
 
 static int negamax(Board& b, int depth, int alpha, int beta, int ply,
-                   uint64_t& nodes, SearchState& st)
+                   uint64_t& nodes, SearchState& st, bool allowNull = true)
 {
-    nodes++;                                    // счет узлов
-    if (st.stop) return 0;
-    if (timeUp(st)) { st.stop = true; return 0; } // таймер
-
-    uint64_t key = b.computeHash();
+    const Search::Params& P = S->params;
+    S->pvLen[ply] = ply;
+    if (shouldStop(st, nodes)) return 0;        // таймер и лимиты
+    nodes++;                                    // счет узлов (после проверки: лимит точный)
+    if (ply > st.seldepth) st.seldepth = ply;
+    if (ply >= MAX_PLY - 1) return evalSide(b);
+
+    // идём ли по PV прошлой итерации
+    bool onPV = st.followPV && ply < (int)st.prevPV.size();
+    st.followPV = false;
+
+    uint64_t key = b.hash;
     TTEntry* tte = probeTT(key);
 
     int alphaOrig = alpha;
@@ -238,12 +570,80 @@ static int negamax(Board& b, int depth, int alpha, int beta, int ply,
         if (tte->flag == TT_UPPER && ttScore <= alpha) return ttScore;
     }
 
+    // битбазы: точный результат без поиска
+    if (st.tbPieces && b.castlingRights == 0 && b.enPassantSquare < 0 &&
+        pieceCount(b) <= st.tbPieces)
+    {
+        Bitbase::Value v;
+        if (Bitbase::probe(b, v)) {
+            if (v == Bitbase::WIN)  return TB_WIN - ply;
+            if (v == Bitbase::LOSS) return -TB_WIN + ply;
+            return 0;
+        }
+    }
+
+    bool inCheckNow = b.inCheck(b.sideToMove);
+    bool pvNode = (beta - alpha > 1);
+    int staticEval = (inCheckNow || depth == 0) ? -INF : evalSide(b);
+
+    if (depth > 0 && !pvNode && !inCheckNow && !isMateScore(beta)) {
+
+        // reverse futility: запас над beta слишком велик
+        if (P.rfpEnabled && depth <= P.rfpMaxDepth &&
+            staticEval - P.rfpMargin * depth >= beta)
+            return staticEval;
+
+        // razoring: безнадёжно ниже alpha — проверяем тактикой
+        if (P.razorEnabled && depth <= P.razorMaxDepth &&
+            staticEval + P.razorMargin * depth < alpha)
+        {
+            int q = quiescence(b, alpha, beta, ply, nodes, st);
+            if (st.stop) return 0;
+            if (q < alpha) return q;
+        }
+    }
+
+    // null move: пропускаем ход, если и так >= beta — узел отсекается.
+    // Не в PV-узлах: там нужен точный счёт и вариант, а не граница
+    if (P.nmpEnabled && allowNull && !pvNode && depth >= P.nmpMinDepth && !isMateScore(beta) &&
+        !inCheckNow && staticEval >= beta && hasNonPawnMaterial(b, b.sideToMove))
+    {
+        int R = P.nmpBaseR + depth / P.nmpDepthDiv
+              + min((staticEval - beta) / P.nmpEvalDiv, P.nmpMaxEvalR);
+        int nullDepth = max(0, depth - 1 - R);
+
+        Undo nu;
+        doNullMove(b, nu);
+        S->moveStack[ply] = StackEntry{};
+        int score = -negamax(b, nullDepth, -beta, -beta + 1, ply + 1, nodes, st, false);
+        undoNullMove(b, nu);
+
+        if (st.stop) return 0;
+
+        if (score >= beta) {
+            if (isMateScore(score)) score = beta;   // мат от null move не доверяем
+
+            if (!P.nmpVerify || depth < P.nmpVerifyDepth)
+                return score;
+
+            // проверка без null move на сокращённой глубине
+            int v = negamax(b, nullDepth, beta - 1, beta, ply, nodes, st, false);
+            if (st.stop) return 0;
+            if (v >= beta) return score;
+        }
+    }
+
+    // IIR: без хода из TT порядок ходов слабый — ищем мельче,
+    // следующая итерация придёт сюда уже с ходом в TT.
+    // Не ниже 1: глубина 0 — это quiescence, отрицательной не бывает
+    if (P.iirEnabled && depth >= P.iirMinDepth && !onPV && tte->key != key)
+        depth = max(1, depth - P.iirReduction);
+
     vector<Move> legal;
     MoveGen::generateLegalMoves(b, legal);       // легальные
 
     if (legal.empty()) {
-        Color us = b.sideToMove;
-        if (b.inCheck(us)) return -MATE + ply;   // мат
+        if (inCheckNow) return -MATE + ply;      // мат
         return 0;                                // пат
     }
 
@@ -251,47 +651,124 @@ static int negamax(Board& b, int depth, int alpha, int beta, int ply,
         return quiescence(b, alpha, beta, ply, nodes, st); // qsearch
 
     const Move* ttMove = (tte->key == key) ? &tte->best : nullptr;
+    if (onPV) ttMove = &st.prevPV[ply];          // ход PV важнее хода из TT
 
-    orderMoves(b, legal, ttMove, ply);           // ordering
+    int scores[MAX_MOVES];
+    scoreMoves(b, legal, scores, ttMove, ply);   // ordering
 
     int bestScore = -INF;
     Move bestMove = legal[0];
+    int moveNum = 0;
+
+    Move quietsTried[64];                        // для malus при отсечении
+    Move capturesTried[32];
+    int nQuiets = 0, nCaptures = 0;
+
+    bool futile = P.futilityEnabled && !pvNode && !inCheckNow &&
+                  depth <= P.futilityMaxDepth && !isMateScore(alpha) &&
+                  staticEval + P.futilityMargin * depth <= alpha;
 
-    for (const auto& m : legal) {
+    for (size_t i = 0; i < legal.size(); ++i) {
+
+        int ms = pickNext(legal, scores, i);
+        const Move& m = legal[i];
+
+        bool quiet = isQuiet(m);
+        bool refutation = quiet && ms >= COUNTER_SCORE;     // killer/countermove
+        int hist = (quiet && !refutation) ? ms : 0;
 
         Undo u;
-        if (!b.makeMove(m, u)) continue;
+        if (!doMove(b, m, u)) continue;
 
-        int score = -negamax(b, depth - 1, -beta, -alpha, ply + 1, nodes, st);
+        moveNum++;
+        bool givesCheck = b.inCheck(b.sideToMove);
+        S->moveStack[ply] = { u.moved, m.to };
 
-        b.unmakeMove(m, u);
+        // futility: тихий ход не поднимет оценку до alpha
+        if (futile && quiet && !givesCheck && moveNum > 1) {
+            undoMove(b, m, u);
+            continue;
+        }
+
+        int score;
+        if (moveNum == 1) {
+            st.followPV = onPV && sameMoveFull(m, st.prevPV[ply]);
+            score = -negamax(b, depth - 1, -beta, -alpha, ply + 1, nodes, st);
+            st.followPV = false;
+        } else {
+            // LMR для поздних тихих ходов
+            int r = 0;
+            if (P.lmrEnabled && depth >= P.lmrMinDepth && moveNum > P.lmrMinMoves &&
+                quiet && !inCheckNow && !givesCheck)
+            {
+                r = lmrReduction(depth, moveNum);
+                if (pvNode) r--;
+                if (refutation) r--;
+                r -= max(-2, min(2, hist / P.lmrHistDiv));   // хорошая история — меньше сокращаем
+                r = min(r, depth - 2);
+                if (r < 0) r = 0;
+            }
+
+            score = -negamax(b, depth - 1 - r, -alpha - 1, -alpha, ply + 1, nodes, st);
+
+            // пересчёт при fail-high
+            if (score > alpha && r > 0)
+                score = -negamax(b, depth - 1, -alpha - 1, -alpha, ply + 1, nodes, st);
+            if (score > alpha && score < beta)
+                score = -negamax(b, depth - 1, -beta, -alpha, ply + 1, nodes, st);
+        }
+
+        undoMove(b, m, u);
+
+        // остановлены: счёт дочернего узла — заглушка, в PV, историю и TT не пишем
+        if (st.stop) return 0;
 
         if (score > bestScore) {
             bestScore = score;
             bestMove = m;
         }
 
-        if (score > alpha) alpha = score;
+        if (score > alpha) {
+            alpha = score;
+            updatePV(ply, m);
+        }
 
         // beta cutoff
         if (alpha >= beta) {
 
-            // killer + history обновление
-            if (isQuiet(m) && ply < MAX_PLY) {
+            int bonus = historyBonus(depth);
+
+            // killer + history обновление, штраф ранее испробованным
+            if (quiet && ply < MAX_PLY) {
 
-                if (!sameMoveFull(m, killers[ply][0])) {
-                    killers[ply][1] = killers[ply][0];
-                    killers[ply][0] = m;
+                if (!sameMoveFull(m, S->killers[ply][0])) {
+                    S->killers[ply][1] = S->killers[ply][0];
+                    S->killers[ply][0] = m;
                 }
 
-                int si = sideIndex(b.sideToMove);
-                historyTable[si][m.from][m.to] += depth * depth;
+                updateQuietHistory(b, m, ply, bonus);
+                for (int j = 0; j < nQuiets; ++j)
+                    updateQuietHistory(b, quietsTried[j], ply, -bonus);
+
+                if (const StackEntry* e = prevMove(ply, 1))
+                    S->counterMoves[(int)e->piece][e->to] = m;
             }
+            else if (m.isCapture) {
+                applyGravity(captureHist(b, m), bonus);
+            }
+
+            for (int j = 0; j < nCaptures; ++j)
+                applyGravity(captureHist(b, capturesTried[j]), -bonus);
 
             break;
         }
+
+        if (quiet && nQuiets < 64) quietsTried[nQuiets++] = m;
+        else if (m.isCapture && nCaptures < 32) capturesTried[nCaptures++] = m;
     }
 
+    if (st.stop) return 0;
+
     // TT запись
     TTFlag flag = TT_EXACT;
     if (bestScore <= alphaOrig) flag = TT_UPPER;
@@ -302,11 +779,265 @@ static int negamax(Board& b, int depth, int alpha, int beta, int ply,
     return bestScore;
 }
 
+struct RootLine {
+    Move move;
+    int score = -INF;
+    vector<Move> pv;
+    uint64_t nodes = 0;          // узлы под этим ходом
+};
+
+// Один проход по корневым ходам (PVS) с K лучшими линиями: окно держится
+// по K-й линии, остальные ходы проверяются нулевым окном против неё.
+// prev — линии прошлой итерации, их ходы идут первыми.
+// false — поиск остановлен, результат неполный.
+static bool searchRoot(Board& b, vector<Move> moves, int depth, int multiPV,
+                       const vector<RootLine>& prev, SearchState& st,
+                       uint64_t& nodes, vector<RootLine>& out)
+{
+    int scores[MAX_MOVES];
+    scoreMoves(b, moves, scores, nullptr, 0);
+    for (size_t i = 0; i < moves.size(); ++i)
+        for (size_t k = 0; k < prev.size(); ++k)
+            if (sameMoveFull(moves[i], prev[k].move))
+                scores[i] = 2'000'000'000 - (int)k;
+
+    const int beta = INF;
+    out.clear();
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+
+        pickNext(moves, scores, i);
+        const Move& m = moves[i];
+
+        // граница — счёт K-й линии, пока линий меньше K — полное окно
+        int alpha = ((int)out.size() < multiPV) ? -INF : out.back().score;
+
+        // главный вариант этой линии с прошлой итерации
+        st.prevPV.clear();
+        for (const auto& l : prev)
+            if (!l.pv.empty() && sameMoveFull(m, l.pv[0])) st.prevPV = l.pv;
+
+        Undo u;
+        if (!doMove(b, m, u)) continue;
+
+        uint64_t moveNodes0 = nodes;
+        S->moveStack[0] = { u.moved, m.to };
+
+        int score;
+        if (alpha == -INF) {
+            st.followPV = !st.prevPV.empty();
+            score = -negamax(b, depth - 1, -beta, -alpha, 1, nodes, st);
+            st.followPV = false;
+        } else {
+            score = -negamax(b, depth - 1, -alpha - 1, -alpha, 1, nodes, st);
+            if (score > alpha && !st.stop)
+                score = -negamax(b, depth - 1, -beta, -alpha, 1, nodes, st);
+        }
+
+        undoMove(b, m, u);
+
+        if (st.stop) return false;
+
+        if (score > alpha) {
+            RootLine line;
+            line.move = m;
+            line.score = score;
+            line.nodes = nodes - moveNodes0;
+            line.pv.assign(1, m);
+            line.pv.insert(line.pv.end(), &S->pvTable[1][1], &S->pvTable[1][S->pvLen[1]]);
+
+            // вставка по убыванию счёта, лишняя линия уходит
+            auto pos = find_if(out.begin(), out.end(),
+                               [&](const RootLine& l) { return score > l.score; });
+            out.insert(pos, line);
+            if ((int)out.size() > multiPV) out.pop_back();
+        }
+    }
+    return true;
+}
+
+// PV, оборванный отсечением по TT, дописываем ходами из TT до maxLen:
+// ponder нужен хотя бы ответ соперника (pv[1]). Ход из TT проверяется на
+// легальность, на повторе позиции останавливаемся.
+static void completePV(Board& b, vector<Move>& pv, int maxLen) {
+    vector<Undo> undos(pv.size());
+    vector<uint64_t> seen{ b.hash };
+    for (size_t i = 0; i < pv.size(); ++i) {
+        b.makeMove(pv[i], undos[i]);
+        seen.push_back(b.hash);
+    }
+
+    vector<Move> legal;
+    while ((int)pv.size() < maxLen) {
+        const TTEntry* e = probeTT(b.hash);
+        if (e->key != b.hash) break;
+        MoveGen::generateLegalMoves(b, legal);
+        auto it = find_if(legal.begin(), legal.end(),
+                          [&](const Move& m) { return sameMoveFull(m, e->best); });
+        if (it == legal.end()) break;
+
+        Move m = *it;
+        undos.emplace_back();
+        b.makeMove(m, undos.back());
+        pv.push_back(m);
+        if (find(seen.begin(), seen.end(), b.hash) != seen.end()) break;
+        seen.push_back(b.hash);
+    }
+
+    for (size_t i = pv.size(); i-- > 0; ) b.unmakeMove(pv[i], undos[i]);
+}
+
+// Корень уже в битбазе: оставляем ходы с лучшим результатом по таблице.
+// Внутри дерева таблицы тогда не пробуются — иначе все выигрывающие ходы
+// равны и поиск не двигает позицию к мату.
+static bool filterRootByBitbase(Board& b, vector<Move>& moves) {
+    Bitbase::Value v;
+    if (!Bitbase::maxPieces() || b.castlingRights != 0 || b.enPassantSquare >= 0 ||
+        pieceCount(b) > Bitbase::maxPieces() || !Bitbase::probe(b, v))
+        return false;
+
+    // результат хода для нас: 2 — выигрыш, 1 — ничья, 0 — проигрыш
+    vector<int> rank(moves.size(), 1);
+    int best = 0;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        Undo u;
+        b.makeMove(moves[i], u);
+        Bitbase::Value cv;
+        if (pieceCount(b) > 2 && Bitbase::probe(b, cv))
+            rank[i] = (cv == Bitbase::LOSS) ? 2 : (cv == Bitbase::WIN) ? 0 : 1;
+        b.unmakeMove(moves[i], u);
+        best = max(best, rank[i]);
+    }
+
+    vector<Move> kept;
+    for (size_t i = 0; i < moves.size(); ++i)
+        if (rank[i] == best) kept.push_back(moves[i]);
+    moves = kept;
+    return true;
+}
+
 namespace Search {
 
+const Params& params() { return S->params; }
+
+void newGame() {
+    lock_guard<mutex> lock(S->busy);
+    clearHeuristics();
+    for (auto& e : S->tt) e = TTEntry{};
+    S->ttGeneration = 0;
+    S->evalCache.clear();
+}
+
+State* createState() {
+    return new State;
+}
+
+void destroyState(State* s) {
+    if (S == s) S = &defaultState;
+    delete s;
+}
+
+void selectState(State* s) {
+    S = s ? s : &defaultState;
+}
+
+State* currentState() {
+    return S;
+}
+
+void setHashSize(size_t mb) {
+    lock_guard<mutex> lock(S->busy);
+    S->resizeTT(mb);
+}
+
+void setEvalCacheSize(size_t mb) {
+    lock_guard<mutex> lock(S->busy);
+    S->evalCache.resize(mb);
+}
+
+bool setEvaluator(Evaluator e) {
+    lock_guard<mutex> lock(S->busy);
+    if (e == Evaluator::Nnue && !Nnue::isLoaded()) return false;
+    S->evaluator = e;
+    S->evalCache.clear();                    // в кэше оценки прежнего оценщика
+    return true;
+}
+
+Evaluator evaluator() {
+    return S->evaluator;
+}
+
+EvalCacheStats evalCacheStats() {
+    lock_guard<mutex> lock(S->busy);
+    return { S->evalCache.probes, S->evalCache.hits };
+}
+
+void setBook(PolyglotBook* book) {
+    lock_guard<mutex> lock(S->busy);
+    S->book = book;
+}
+
+void setParams(const Params& p) {
+    lock_guard<mutex> lock(S->busy);
+    S->params = p;
+    for (int Params::* div : { &Params::nmpDepthDiv, &Params::nmpEvalDiv,
+                               &Params::lmrDiv, &Params::lmrHistDiv })
+        S->params.*div = max(1, S->params.*div);      // делим на них в поиске
+    initLmr();
+}
+
+bool setParam(const string& name, int value) {
+    // допустимые значения: за пределами — отказ (делители — не меньше 1)
+    struct Entry { const char* name; int Params::* field; int lo, hi; };
+    static const Entry table[] = {
+        { "nmpEnabled",       &Params::nmpEnabled,       0, 1 },
+        { "nmpMinDepth",      &Params::nmpMinDepth,      1, 20 },
+        { "nmpBaseR",         &Params::nmpBaseR,         0, 6 },
+        { "nmpDepthDiv",      &Params::nmpDepthDiv,      1, 16 },
+        { "nmpEvalDiv",       &Params::nmpEvalDiv,       1, 2000 },
+        { "nmpMaxEvalR",      &Params::nmpMaxEvalR,      0, 6 },
+        { "nmpVerify",        &Params::nmpVerify,        0, 1 },
+        { "nmpVerifyDepth",   &Params::nmpVerifyDepth,   1, 64 },
+        { "lmrEnabled",       &Params::lmrEnabled,       0, 1 },
+        { "lmrMinDepth",      &Params::lmrMinDepth,      1, 20 },
+        { "lmrMinMoves",      &Params::lmrMinMoves,      0, 64 },
+        { "lmrBase",          &Params::lmrBase,          0, 300 },
+        { "lmrDiv",           &Params::lmrDiv,           1, 1000 },
+        { "lmrHistDiv",       &Params::lmrHistDiv,       1, 100000 },
+        { "futilityEnabled",  &Params::futilityEnabled,  0, 1 },
+        { "futilityMaxDepth", &Params::futilityMaxDepth, 0, 10 },
+        { "futilityMargin",   &Params::futilityMargin,   0, 1000 },
+        { "rfpEnabled",       &Params::rfpEnabled,       0, 1 },
+        { "rfpMaxDepth",      &Params::rfpMaxDepth,      0, 16 },
+        { "rfpMargin",        &Params::rfpMargin,        0, 1000 },
+        { "razorEnabled",     &Params::razorEnabled,     0, 1 },
+        { "razorMaxDepth",    &Params::razorMaxDepth,    0, 8 },
+        { "razorMargin",      &Params::razorMargin,      0, 2000 },
+        { "iirEnabled",       &Params::iirEnabled,       0, 1 },
+        { "iirMinDepth",      &Params::iirMinDepth,      1, 20 },
+        { "iirReduction",     &Params::iirReduction,     0, 4 },
+        { "qsSeePrune",       &Params::qsSeePrune,       0, 1 },
+        { "qsDeltaEnabled",   &Params::qsDeltaEnabled,   0, 1 },
+        { "qsDeltaMargin",    &Params::qsDeltaMargin,    0, 2000 },
+    };
+
+    for (const auto& e : table) {
+        if (name == e.name) {
+            if (value < e.lo || value > e.hi) return false;
+            Params p = S->params;
+            p.*(e.field) = value;
+            setParams(p);
+            return true;
+        }
+    }
+    return false;
+}
+
 Result findBestMove(Board& b, int depth) {
+    lock_guard<mutex> lock(S->busy);
 
-    clearHeuristics(); // очистка таблиц
+    newSearch(b);      // тёплый старт: история прошлых ходов сохраняется
+    if (!S->lmrInit) initLmr();
 
     Result res;
     res.nodes = 0;
@@ -320,7 +1051,8 @@ Result findBestMove(Board& b, int depth) {
         return res;
     }
 
-    orderMoves(b, legal, nullptr, 0);
+    int scores[MAX_MOVES];
+    scoreMoves(b, legal, scores, nullptr, 0);
 
     int bestScore = -INF;
     Move bestMove = legal[0];
@@ -331,14 +1063,18 @@ Result findBestMove(Board& b, int depth) {
     SearchState st;
     st.deadline = chrono::steady_clock::time_point::max(); // без таймера
 
-    for (const auto& m : legal) {
+    for (size_t i = 0; i < legal.size(); ++i) {
+
+        pickNext(legal, scores, i);
+        const Move& m = legal[i];
 
         Undo u;
-        if (!b.makeMove(m, u)) continue;
+        if (!doMove(b, m, u)) continue;
 
+        S->moveStack[0] = { u.moved, m.to };
         int score = -negamax(b, depth - 1, -beta, -alpha, 1, res.nodes, st);
 
-        b.unmakeMove(m, u);
+        undoMove(b, m, u);
 
         if (score > bestScore) {
             bestScore = score;
@@ -355,12 +1091,32 @@ Result findBestMove(Board& b, int depth) {
 }
 
 Result findBestMoveTimed(Board& b, int maxDepth, int timeMs) {
+    Limits lim;
+    lim.depth = maxDepth;
+    lim.time.movetime = timeMs;
+    lim.useBook = true;
+    return search(b, lim);
+}
 
-    clearHeuristics(); // очистка таблиц
+Result search(Board& b, const Limits& lim) {
+    lock_guard<mutex> lock(S->busy);
 
     Result res;
     res.nodes = 0;
 
+    // дебютная книга: ход без поиска (при ponder — обычный поиск)
+    Move bookMove;
+    if (lim.useBook && !lim.ponder && S->book && S->book->probe(b, bookMove)) {
+        res.best = bookMove;
+        res.pv.assign(1, bookMove);
+        res.lines.push_back({ 0, res.pv });
+        res.fromBook = true;
+        return res;
+    }
+
+    newSearch(b, !lim.ponder);   // тёплый старт: история сохраняется, ослабляется раз на ход
+    if (!S->lmrInit) initLmr();
+
     vector<Move> legalRoot;
     MoveGen::generateLegalMoves(b, legalRoot);
 
@@ -371,56 +1127,98 @@ Result findBestMoveTimed(Board& b, int maxDepth, int timeMs) {
         return res;
     }
 
-    SearchState st;
-    st.deadline = chrono::steady_clock::now() + chrono::milliseconds(timeMs);
+    bool rootInBitbase = filterRootByBitbase(b, legalRoot);
 
-    Move bestMove = legalRoot[0];
-    Move pvMove   = bestMove;
-    int bestScore = -INF;
-    int depthDone = 0;
+    TimeMan::Manager tm;
+    tm.start(lim.ponder ? TimeMan::Control{} : lim.time, b.sideToMove);
 
-    for (int depth = 1; depth <= maxDepth; ++depth) {
+    SearchState st;
+    st.deadline = tm.deadline();
+    st.start = chrono::steady_clock::now();
+    st.signals = lim.signals;
+    st.stopFlag = lim.signals ? &lim.signals->stop : nullptr;
+    st.maxNodes = lim.nodes;
+    st.tbPieces = rootInBitbase ? 0 : Bitbase::maxPieces();
+    st.pondering = lim.ponder && lim.signals;
+    st.tm = &tm;
+    st.tc = &lim.time;
+    st.side = b.sideToMove;
+    if (lim.onProgress) {
+        st.progress = &lim.onProgress;
+        st.reportEvery = chrono::milliseconds(lim.progressIntervalMs);
+        st.nextReport = st.start + st.reportEvery;
+    }
 
-        if (timeUp(st)) { st.stop = true; break; }
+    int multiPV = max(1, min(lim.multiPV, (int)legalRoot.size()));
 
-        vector<Move> legal = legalRoot;
+    vector<RootLine> lines;                      // последняя завершённая итерация
+    int depthDone = 0;
+    int64_t lastIterMs = 0;
+
+    for (int depth = 1; depth <= lim.depth; ++depth) {
 
-        orderMoves(b, legal, &pvMove, 0);
+        pollClock(st, res.nodes);                // сигналы между итерациями
+        if (st.stop) break;
 
-        int alpha = -INF;
-        int beta  = INF;
+        // первую итерацию делаем всегда, дальше — если успеем
+        if (depth > 1 && !st.pondering && !tm.canStartIteration(lastIterMs)) break;
 
-        Move iterBest = legal[0];
-        int iterBestScore = -INF;
+        int64_t iterStart = tm.elapsedMs();
+        uint64_t iterNodes0 = res.nodes;
 
-        for (const auto& m : legal) {
+        vector<RootLine> iterLines;
+        if (!searchRoot(b, legalRoot, depth, multiPV, lines, st, res.nodes, iterLines))
+            break;
 
-            Undo u;
-            if (!b.makeMove(m, u)) continue;
+        bool changed = (depth > 1) && !sameMoveFull(iterLines[0].move, lines[0].move);
+        uint64_t iterNodes = res.nodes - iterNodes0;
 
-            int score = -negamax(b, depth - 1, -beta, -alpha, 1, res.nodes, st);
+        lines = iterLines;
+        depthDone = depth;
+        lastIterMs = max<int64_t>(0, tm.elapsedMs() - iterStart);
 
-            b.unmakeMove(m, u);
+        tm.iterationDone(depth, changed, lines[0].score,
+                         iterNodes ? (double)lines[0].nodes / iterNodes : 1.0);
 
-            if (score > iterBestScore) {
-                iterBestScore = score;
-                iterBest = m;
+        if (st.progress) {
+            auto now = chrono::steady_clock::now();
+            for (int k = 0; k < (int)lines.size(); ++k) {
+                st.last.depth = depth;
+                st.last.multipv = k + 1;
+                st.last.score = lines[k].score;
+                st.last.pv = lines[k].pv;
+                (*st.progress)(makeInfo(st, res.nodes, now));
             }
-            if (score > alpha) alpha = score;
+            st.last.multipv = 1;
+            st.last.score = lines[0].score;
+            st.last.pv = lines[0].pv;
         }
+    }
 
-        if (!st.stop) {
-            bestMove  = iterBest;
-            pvMove    = iterBest;
-            bestScore = iterBestScore;
-            depthDone = depth;
-        } else break;
+    if (lines.empty()) {                         // не успели ни одной итерации
+        RootLine l;
+        l.move = legalRoot[0];
+        l.score = -INF;
+        lines.push_back(l);
     }
 
-    res.best = bestMove;
-    res.score = bestScore;
+    // в режиме ponder ответ нужен только после ponderhit или stop
+    while (st.pondering && !st.stop) {
+        uint32_t ev = st.signals->events.load();
+        pollClock(st, res.nodes);
+        if (st.pondering && !st.stop) st.signals->events.wait(ev);
+    }
+
+    for (auto& l : lines)
+        if (!l.pv.empty()) completePV(b, l.pv, max(2, depthDone));
+
+    res.best = lines[0].move;
+    res.score = lines[0].score;
+    res.pv = lines[0].pv;
     res.depthDone = depthDone;
-    res.timedOut = (depthDone < maxDepth);
+    res.timedOut = (depthDone < lim.depth);
+    for (const auto& l : lines)
+        res.lines.push_back({ l.score, l.pv });
     return res;
 }
 
@@ -1,7 +1,15 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
 #include "board.h"
 #include "move.h"
+#include "timeman.h"
+
+class PolyglotBook;
 
 namespace Search {
     struct Result {
@@ -10,7 +18,152 @@ namespace Search {
         uint64_t nodes = 0;
         int depthDone = 0;
         int timedOut = false;
+        bool fromBook = false;    // ход из дебютной книги, поиска не было
+        std::vector<Move> pv;     // главный вариант, pv[0] == best
+
+        struct Line { int score = 0; std::vector<Move> pv; };
+        std::vector<Line> lines;  // Multi-PV: лучшие линии по убыванию, lines[0] — главная
+    };
+
+    // Параметры отсечений и сокращений (для тюнинга)
+    struct Params {
+        // null move
+        int nmpEnabled     = 1;
+        int nmpMinDepth    = 3;
+        int nmpBaseR       = 2;
+        int nmpDepthDiv    = 4;
+        int nmpEvalDiv     = 200;
+        int nmpMaxEvalR    = 2;
+        int nmpVerify      = 1;
+        int nmpVerifyDepth = 10;
+
+        // LMR: r = base/100 + ln(depth) * ln(moveNum) * 100/div
+        int lmrEnabled  = 1;
+        int lmrMinDepth = 3;
+        int lmrMinMoves = 3;
+        int lmrBase     = 75;
+        int lmrDiv      = 225;
+        int lmrHistDiv  = 4000;       // -1 к r за каждые 4000 истории (до +-2)
+
+        // futility (тихие ходы у горизонта)
+        int futilityEnabled  = 1;
+        int futilityMaxDepth = 3;
+        int futilityMargin   = 120;   // на полуход
+
+        // reverse futility (static null move)
+        int rfpEnabled  = 1;
+        int rfpMaxDepth = 6;
+        int rfpMargin   = 90;         // на полуход
+
+        // razoring
+        int razorEnabled  = 1;
+        int razorMaxDepth = 2;
+        int razorMargin   = 250;      // на полуход
+
+        // IIR: нет хода из TT — сокращаем глубину узла
+        int iirEnabled   = 1;
+        int iirMinDepth  = 4;
+        int iirReduction = 1;
+
+        // quiescence: SEE < 0 и delta pruning
+        int qsSeePrune     = 1;
+        int qsDeltaEnabled = 1;
+        int qsDeltaMargin  = 200;
+    };
+
+    // Прогресс поиска: после каждой итерации и (опционально) по таймеру
+    struct Info {
+        int depth = 0;
+        int seldepth = 0;
+        int score = 0;
+        uint64_t nodes = 0;
+        uint64_t nps = 0;
+        int64_t timeMs = 0;
+        int hashfull = 0;         // заполнение TT, промилле
+        int evalHits = 0;         // попадания в кэш оценок за поиск, промилле
+        int multipv = 1;          // номер линии (1 — лучшая)
+        bool iterationDone = true; // false — промежуточный отчёт внутри итерации
+        std::vector<Move> pv;     // PV последней завершённой итерации
+                                  // (depth/score/pv в промежуточном — тоже её)
     };
+    using ProgressFn = std::function<void(const Info&)>;
+
+    // Сигналы поиску из другого потока. stop проверяется в каждом узле,
+    // поиск возвращает последнюю завершённую итерацию.
+    struct Signals {
+        std::atomic<bool> stop{ false };
+        std::atomic<bool> ponderhit{ false };   // соперник сыграл ожидаемый ход
+        std::atomic<uint32_t> events{ 0 };      // будит ожидание после ponder
+
+        void requestStop() { stop = true; wake(); }
+        void ponderHit()   { ponderhit = true; wake(); }
+        void reset()       { stop = false; ponderhit = false; }
+
+    private:
+        void wake() { events.fetch_add(1); events.notify_all(); }
+    };
+
+    // Ограничения поиска
+    struct Limits {
+        int depth = 64;
+        uint64_t nodes = 0;       // 0 — без ограничения; ровно столько узлов, не больше.
+                                  // Без лимита времени результат детерминирован
+                                  // (после newGame — одинаков от запуска к запуску)
+        TimeMan::Control time;    // по умолчанию без ограничения времени
+
+        int multiPV = 1;          // сколько лучших линий искать
+        bool useBook = false;     // сначала ход из книги (см. setBook)
+
+        Signals* signals = nullptr;
+        bool ponder = false;      // время не идёт до ponderhit, раньше не отвечаем
+
+        ProgressFn onProgress;          // может быть пустым
+        int64_t progressIntervalMs = 0; // 0 — только по итерациям
+    };
+
+    const Params& params();
+    void setParams(const Params& p);     // делители меньше 1 поднимаются до 1
+    bool setParam(const std::string& name, int value); // false — нет такого параметра
+                                                       // или значение вне его диапазона
+
+    // Полный сброс TT и истории перед новой партией.
+    // Между ходами одной партии состояние сохраняется (история ослабляется, TT стареет).
+    void newGame();
+
+    // Состояние поиска: TT, история, кэш оценок, параметры, оценщик, книга
+    // и рабочие массивы. Всё выше (newGame, setParams, setEvaluator...) и
+    // поиски работают с текущим состоянием потока. По умолчанию у всех потоков
+    // одно общее; поиски с одним состоянием идут по очереди, с разными —
+    // параллельно (матч: поток на партию, у каждого движка своё).
+    struct State;
+    State* createState();                 // как после newGame: параметры по умолчанию, Classic
+    void destroyState(State* s);          // s не должно быть текущим в других потоках
+    void selectState(State* s);           // только для вызывающего потока; nullptr — по умолчанию
+    State* currentState();                // текущее состояние потока (передать в другой поток)
+
+    // Оценка позиции: Eval::score или NNUE (сеть загружается Nnue::load до поисков;
+    // после загрузки другой сети — снова setEvaluator, чтобы сбросить кэш оценок)
+    enum class Evaluator { Classic, Nnue };
+    bool setEvaluator(Evaluator e);       // false — сеть не загружена, оценщик прежний
+    Evaluator evaluator();
+
+    // Размер TT текущего состояния, по умолчанию 32 МБ (у каждого состояния
+    // своя). Округляется вниз до степени двойки записей; TT очищается.
+    void setHashSize(size_t mb);
+
+    // Кэш оценок позиций, по умолчанию 2 МБ; 0 — выключен.
+    // Статистика считается с начала последнего поиска.
+    void setEvalCacheSize(size_t mb);
+    struct EvalCacheStats { uint64_t probes = 0; uint64_t hits = 0; };
+    EvalCacheStats evalCacheStats();
+
+    // Дебютная книга текущего состояния для поисков с Limits::useBook;
+    // nullptr — без книги. Книга должна жить, пока используется.
+    void setBook(PolyglotBook* book);
+
+    // Поиск идёт синхронно в потоке вызывающего, с его текущим состоянием;
+    // остановить поиск из другого потока — Limits::signals->requestStop().
     Result findBestMove(Board& b, int depth);
     Result findBestMoveTimed(Board& b, int maxDepth, int timeMs);
+    Result search(Board& b, const Limits& lim);
 }
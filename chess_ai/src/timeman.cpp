@@ -0,0 +1,98 @@
+#include "timeman.h"
+#include <algorithm>
+
+using namespace std;
+
+static const int    MTG_DEFAULT     = 30;   // горизонт при sudden death
+static const int    MTG_MAX         = 50;
+static const int    HARD_SOFT_RATIO = 4;    // hard не больше 4 x soft
+static const double HARD_MAX_FRAC   = 0.5;  // и не больше половины остатка
+static const int    ITER_GROWTH     = 2;    // следующая итерация ~ в 2 раза дольше
+
+// Адаптация к стабильности лучшего хода
+static const int    ADAPT_MIN_DEPTH = 5;    // мелкие итерации слишком шумные
+static const double CHANGE_DECAY    = 0.5;
+static const double CHANGE_WEIGHT   = 0.75; // +75% за свежую смену хода
+static const double STABLE_STEP     = 0.07; // -7% за итерацию без смены
+static const double STABLE_MIN      = 0.55;
+static const int    DROP_CAP        = 200;  // падение оценки, сантипешки
+static const double DROP_WEIGHT     = 0.8;
+static const double NODES_BASE      = 1.5;  // 1.5 - доля узлов под лучшим ходом
+static const double FACTOR_MIN      = 0.3;
+
+namespace TimeMan {
+
+void Manager::start(const Control& tc, Color side) {
+    t0 = chrono::steady_clock::now();
+    softMs = -1;
+    hardMs = -1;
+    optimumMs = -1;
+    changes = 0.0;
+    stableIters = 0;
+    prevScore = 0;
+    havePrev = false;
+
+    if (tc.movetime >= 0) {
+        softMs = hardMs = optimumMs = max<int64_t>(1, tc.movetime);
+        return;
+    }
+
+    int64_t time = (side == Color::White) ? tc.wtime : tc.btime;
+    int64_t inc  = (side == Color::White) ? tc.winc  : tc.binc;
+    if (time < 0) return;                    // без ограничения
+
+    int64_t avail = max<int64_t>(1, time - tc.overhead);
+    int mtg = (tc.movestogo > 0) ? min(tc.movestogo, MTG_MAX) : MTG_DEFAULT;
+
+    softMs = avail / mtg + inc * 3 / 4;
+
+    // последний ход до контроля можно тратить почти целиком
+    double maxFrac = (tc.movestogo == 1) ? 0.9 : HARD_MAX_FRAC;
+    hardMs = min<int64_t>(softMs * HARD_SOFT_RATIO, (int64_t)(avail * maxFrac));
+    hardMs = max<int64_t>(1, hardMs);
+    softMs = max<int64_t>(1, min(softMs, hardMs));
+    optimumMs = softMs;
+}
+
+void Manager::iterationDone(int depth, bool bestChanged, int score, double bestNodeFrac) {
+    changes = changes * CHANGE_DECAY + (bestChanged ? 1.0 : 0.0);
+    stableIters = bestChanged ? 0 : stableIters + 1;
+
+    int drop = havePrev ? prevScore - score : 0;
+    prevScore = score;
+    havePrev = true;
+
+    if (!limited() || depth < ADAPT_MIN_DEPTH) return;
+
+    double fChange = 1.0 + CHANGE_WEIGHT * changes;
+    double fStable = max(STABLE_MIN, 1.0 - STABLE_STEP * stableIters);
+    double fDrop   = 1.0 + DROP_WEIGHT * min(max(drop, 0), DROP_CAP) / DROP_CAP;
+    double fNodes  = NODES_BASE - min(max(bestNodeFrac, 0.0), 1.0);
+
+    double f = max(FACTOR_MIN, fChange * fStable * fDrop * fNodes);
+
+    // продлеваем не дальше hard, для movetime — только раньше останавливаемся
+    optimumMs = min<int64_t>(hardMs, max<int64_t>(1, (int64_t)(softMs * f)));
+}
+
+int64_t Manager::elapsedMs() const {
+    return chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - t0).count();
+}
+
+chrono::steady_clock::time_point Manager::deadline() const {
+    if (hardMs < 0) return chrono::steady_clock::time_point::max();
+    return t0 + chrono::milliseconds(hardMs);
+}
+
+bool Manager::canStartIteration(int64_t lastIterMs) const {
+    if (!limited()) return true;
+
+    int64_t el = elapsedMs();
+    if (el >= optimumMs) return false;
+
+    // не начинаем итерацию, которую не успеем закончить
+    return el + lastIterMs * ITER_GROWTH < hardMs;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include "board.h"
+
+namespace TimeMan {
+    // Контроль времени (мс). -1 — не задано
+    struct Control {
+        int64_t wtime = -1;
+        int64_t btime = -1;
+        int64_t winc = 0;
+        int64_t binc = 0;
+        int movestogo = 0;        // 0 — до конца партии
+        int64_t movetime = -1;    // фиксированное время на ход
+        int64_t overhead = 30;    // запас на задержки GUI/ОС
+    };
+
+    class Manager {
+    public:
+        void start(const Control& tc, Color side);
+
+        bool limited() const { return hardMs >= 0; }
+        int64_t softLimit() const { return optimumMs; }
+        int64_t hardLimit() const { return hardMs; }
+        int64_t elapsedMs() const;
+
+        std::chrono::steady_clock::time_point deadline() const;
+
+        // итог итерации: сменился ли лучший ход, оценка,
+        // доля узлов итерации под лучшим ходом (0..1)
+        void iterationDone(int depth, bool bestChanged, int score, double bestNodeFrac);
+
+        // можно ли начать итерацию, если прошлая заняла lastIterMs
+        bool canStartIteration(int64_t lastIterMs) const;
+
+    private:
+        std::chrono::steady_clock::time_point t0;
+        int64_t softMs = -1;      // базовое желаемое время на ход
+        int64_t hardMs = -1;      // абсолютный предел
+        int64_t optimumMs = -1;   // soft с поправкой на стабильность
+
+        double changes = 0.0;     // затухающий счётчик смен лучшего хода
+        int stableIters = 0;      // итераций подряд без смены
+        int prevScore = 0;
+        bool havePrev = false;
+    };
+}
@@ -0,0 +1,369 @@
+// chess_tuner: Texel-тюнинг параметров оценки, результат — новый eval_params.h.
+// Запуск: chess_tuner <позиции.epd> [выход] [потоков] [эпох] [шаг]
+// Строка данных: FEN (первые 4 поля) и результат партии за белых в любом виде:
+// 1-0 / 0-1 / 1/2-1/2 (в том числе EPD c9 "1-0";) или [1.0] / [0.5] / [0.0].
+//
+// Каждая позиция один раз сводится quiescence-поиском к спокойной и
+// раскладывается Eval::trace в линейную сумму по параметрам. Эпохи дальше
+// идут без доски: оценка — скалярное произведение, ошибка — квадрат разности
+// результата и сигмоиды оценки, шаги — Adam по полному градиенту.
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cctype>
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "eval.h"
+#include "mapped_file.h"
+
+using namespace std;
+
+// коэффициент параметра в оценке позиции: mg и eg уже смешаны по фазе
+struct Coef {
+    uint16_t index;
+    float weight;
+};
+
+struct Sample {
+    uint32_t first;     // начало коэффициентов в Shard::coefs
+    uint16_t count;
+    float result;       // за белых: 1, 0.5, 0
+};
+
+// позиции одного потока: загружаются и считаются им же
+struct Shard {
+    vector<Sample> samples;
+    vector<Coef> coefs;
+    uint64_t skipped = 0;
+};
+
+// f(t, from, to) по диапазонам [0, n) в нескольких потоках
+template <class F>
+static void parallelFor(int threads, uint64_t n, F f) {
+    vector<thread> pool;
+    uint64_t chunk = (n + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        uint64_t from = chunk * t;
+        uint64_t to = min(n, from + chunk);
+        if (from >= to) break;
+        pool.emplace_back([&f, t, from, to]() { f(t, from, to); });
+    }
+    for (auto& th : pool) th.join();
+}
+
+// ---- Загрузка ----
+
+static bool parseResult(const char* s, const char* end, float& r) {
+    const char* br = find(s, end, '[');
+    if (br != end) {
+        r = strtof(br + 1, nullptr);
+        return r >= 0.0f && r <= 1.0f;
+    }
+
+    string line(s, end);
+    if (line.find("1/2-1/2") != string::npos) r = 0.5f;
+    else if (line.find("1-0") != string::npos) r = 1.0f;
+    else if (line.find("0-1") != string::npos) r = 0.0f;
+    else return false;
+    return true;
+}
+
+static const int QS_MAX_PLY = 16;
+static const int QS_DELTA_MARGIN = 200;     // как Search::Params::qsDeltaMargin
+
+// Взятия и превращения, как quiescence в поиске: MVV-LVA, без проигрышных
+// по SEE и без взятий, которые не дотягивают до alpha (delta).
+// leaf — спокойная позиция в конце лучшего варианта, trace — только для неё
+static int qsearch(Board& b, int alpha, int beta, int ply, Board& leaf) {
+    int stand = Eval::score(b);
+    if (b.sideToMove == Color::Black) stand = -stand;
+
+    leaf = b;
+    if (stand >= beta || ply >= QS_MAX_PLY) return stand;
+    if (stand > alpha) alpha = stand;
+
+    vector<Move> pseudo;
+    MoveGen::generateAllPseudoMoves(b, pseudo);
+
+    struct Scored { Move m; int score; };
+    vector<Scored> moves;
+    for (const auto& m : pseudo) {
+        if (!m.isCapture && !m.isEnPassant && m.promotion == Piece::Empty) continue;
+        Piece victim = m.isEnPassant ? Piece::WP : b.sq[m.to];
+        if (m.promotion == Piece::Empty &&
+            stand + MoveGen::pieceValue(victim) + QS_DELTA_MARGIN <= alpha)
+            continue;
+        if (MoveGen::see(b, m) < 0) continue;
+        moves.push_back({ m, 10 * MoveGen::pieceValue(victim) + MoveGen::pieceValue(m.promotion)
+                             - MoveGen::pieceValue(b.sq[m.from]) });
+    }
+    sort(moves.begin(), moves.end(), [](const Scored& x, const Scored& y) { return x.score > y.score; });
+
+    Board childLeaf;
+    for (const auto& [m, score] : moves) {
+        Undo u;
+        if (!b.makeMove(m, u)) continue;
+        if (b.inCheck(b.sideToMove == Color::White ? Color::Black : Color::White)) {
+            b.unmakeMove(m, u);
+            continue;
+        }
+        int s = -qsearch(b, -beta, -alpha, ply + 1, childLeaf);
+        b.unmakeMove(m, u);
+
+        if (s > alpha) {
+            alpha = s;
+            leaf = childLeaf;
+            if (s >= beta) break;
+        }
+    }
+    return alpha;
+}
+
+// строки из [from, to) байт файла; строка принадлежит куску, где она начинается
+static void loadChunk(const MappedFile& file, uint64_t from, uint64_t to, Shard& shard) {
+    const char* data = (const char*)file.data();
+    const char* end = data + file.size();
+    const char* p = data + from;
+    if (from > 0 && p[-1] != '\n') {
+        const char* nl = find(p, end, '\n');
+        p = nl + (nl < end ? 1 : 0);
+    }
+
+    Eval::Trace tr;
+    Board b, leaf;
+
+    while (p < data + to && p < end) {
+        const char* eol = find(p, end, '\n');
+        const char* line = p;
+        p = eol + (eol < end ? 1 : 0);
+
+        // FEN — первые 4 поля: дальше в EPD идут операции, а не счётчики ходов
+        string fen;
+        const char* q = line;
+        for (int field = 0; field < 4 && q < eol; ++field) {
+            while (q < eol && isspace((unsigned char)*q)) ++q;
+            const char* start = q;
+            while (q < eol && !isspace((unsigned char)*q)) ++q;
+            if (start == q) break;
+            if (field) fen += ' ';
+            fen.append(start, q);
+        }
+
+        float result;
+        if (fen.empty()) continue;
+        if (!parseResult(q, eol, result) || !b.setFromFEN(fen) ||
+            b.kingSquare(Color::White) < 0 || b.kingSquare(Color::Black) < 0) {
+            shard.skipped++;
+            continue;
+        }
+
+        qsearch(b, -100000, 100000, 0, leaf);
+        Eval::trace(leaf, tr);
+
+        Sample s{ (uint32_t)shard.coefs.size(), (uint16_t)tr.terms.size(), result };
+        for (const auto& t : tr.terms) {
+            float w = (t.mg * (256.0f - tr.egW) + t.eg * (float)tr.egW) / 256.0f;
+            shard.coefs.push_back({ t.index, w });
+        }
+        shard.samples.push_back(s);
+    }
+}
+
+// ---- Ошибка и градиент ----
+
+static const double LN10_400 = 2.302585092994046 / 400.0;
+
+// ожидаемый результат за белых при оценке e: 1 / (1 + 10^(-k e / 400))
+static double sigmoid(double k, double e) {
+    return 1.0 / (1.0 + exp(-k * e * LN10_400));
+}
+
+static double evaluate(const Shard& sh, const Sample& s, const vector<double>& params) {
+    double e = 0;
+    const Coef* c = sh.coefs.data() + s.first;
+    for (int i = 0; i < s.count; ++i) e += params[c[i].index] * c[i].weight;
+    return e;
+}
+
+// средняя ошибка; grad (если не null) — её градиент по параметрам
+static double pass(vector<Shard>& shards, const vector<double>& params, double k, vector<double>* grad) {
+    int threads = (int)shards.size();
+    vector<double> errors(threads, 0.0);
+    vector<vector<double>> grads(threads);
+
+    parallelFor(threads, threads, [&](int t, uint64_t, uint64_t) {
+        const Shard& sh = shards[t];
+        vector<double>& g = grads[t];
+        if (grad) g.assign(params.size(), 0.0);
+
+        double err = 0;
+        for (const auto& s : sh.samples) {
+            double sig = sigmoid(k, evaluate(sh, s, params));
+            double diff = sig - s.result;
+            err += diff * diff;
+            if (!grad) continue;
+
+            // d(diff²)/de = 2 * diff * σ(1 - σ) * k ln10 / 400
+            double d = 2.0 * diff * sig * (1.0 - sig) * k * LN10_400;
+            const Coef* c = sh.coefs.data() + s.first;
+            for (int i = 0; i < s.count; ++i) g[c[i].index] += d * c[i].weight;
+        }
+        errors[t] = err;
+    });
+
+    uint64_t n = 0;
+    double err = 0;
+    for (int t = 0; t < threads; ++t) {
+        n += shards[t].samples.size();
+        err += errors[t];
+    }
+    if (grad) {
+        grad->assign(params.size(), 0.0);
+        for (const auto& g : grads)
+            for (size_t i = 0; i < g.size(); ++i) (*grad)[i] += g[i] / n;
+    }
+    return err / n;
+}
+
+// масштаб сигмоиды, при котором исходные параметры лучше всего предсказывают результат
+static double fitK(vector<Shard>& shards, const vector<double>& params) {
+    double lo = 0.1, hi = 3.0;
+    const double phi = (sqrt(5.0) - 1) / 2;
+    double a = hi - phi * (hi - lo), b = lo + phi * (hi - lo);
+    double fa = pass(shards, params, a, nullptr), fb = pass(shards, params, b, nullptr);
+
+    for (int it = 0; it < 30; ++it) {
+        if (fa < fb) { hi = b; b = a; fb = fa; a = hi - phi * (hi - lo); fa = pass(shards, params, a, nullptr); }
+        else         { lo = a; a = b; fa = fb; b = lo + phi * (hi - lo); fb = pass(shards, params, b, nullptr); }
+    }
+    return (lo + hi) / 2;
+}
+
+// ---- Вывод ----
+
+static bool writeParams(const string& path, const vector<double>& params) {
+    ofstream out(path);
+    if (!out) return false;
+
+    out << "#pragma once\n\n"
+        << "// Параметры оценки в сантипешках. Таблицы по клеткам — a1..h8 по горизонталям\n"
+        << "// с точки зрения белых, для чёрных отражаются. Файл перезаписывает chess_tuner;\n"
+        << "// набор и порядок параметров — Eval::paramTables().\n"
+        << "namespace EvalParams {\n";
+
+    char buf[32];
+    size_t idx = 0;
+    for (const auto& t : Eval::paramTables()) {
+        if (t.comment[0] || t.size > 1) out << "\n";
+        if (t.comment[0]) out << "    // " << t.comment << "\n";
+
+        auto value = [&](int i) { return (long)lround(params[idx + i]); };
+        if (t.size == 1) {
+            out << "    inline constexpr int " << t.name << " = " << value(0) << ";\n";
+        } else if (t.size == 64) {
+            out << "    inline constexpr int " << t.name << "[64] = {\n";
+            for (int r = 0; r < 8; ++r) {
+                out << "       ";
+                for (int f = 0; f < 8; ++f) {
+                    snprintf(buf, sizeof(buf), " %4ld,", value(r * 8 + f));
+                    out << buf;
+                }
+                out << "\n";
+            }
+            out << "    };\n";
+        } else {
+            out << "    inline constexpr int " << t.name << "[" << t.size << "] = { ";
+            for (int i = 0; i < t.size; ++i) out << (i ? ", " : "") << value(i);
+            out << " };\n";
+        }
+        idx += t.size;
+    }
+    out << "}\n";
+    return (bool)out;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: chess_tuner <positions.epd> [out=eval_params.h] [threads] [epochs=300] [rate=1.0]\n";
+        return 1;
+    }
+    string dataPath = argv[1];
+    string outPath = (argc > 2) ? argv[2] : "eval_params.h";
+    int threads = (argc > 3) ? stoi(argv[3]) : (int)max(1u, thread::hardware_concurrency());
+    int epochs = (argc > 4) ? stoi(argv[4]) : 300;
+    double rate = (argc > 5) ? stod(argv[5]) : 1.0;
+
+    MappedFile file;
+    if (!file.open(dataPath)) {
+        cerr << "cannot open " << dataPath << "\n";
+        return 1;
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    auto seconds = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - t0).count(); };
+
+    vector<Shard> shards(threads);
+    parallelFor(threads, file.size(), [&](int t, uint64_t from, uint64_t to) {
+        loadChunk(file, from, to, shards[t]);
+    });
+    file.close();
+
+    uint64_t n = 0, skipped = 0, coefs = 0;
+    for (const auto& sh : shards) {
+        n += sh.samples.size();
+        skipped += sh.skipped;
+        coefs += sh.coefs.size();
+    }
+    cout << "Positions: " << n << " (skipped " << skipped << "), "
+         << (n ? (double)coefs / n : 0.0) << " terms each, loaded in " << seconds() << " s" << endl;
+    if (n == 0) return 1;
+
+    vector<double> params;
+    for (const auto& t : Eval::paramTables())
+        for (int i = 0; i < t.size; ++i) params.push_back(t.values[i]);
+
+    double k = fitK(shards, params);
+    cout << "K = " << k << ", error " << pass(shards, params, k, nullptr) << endl;
+
+    // Adam
+    const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+    vector<double> grad, m(params.size(), 0.0), v(params.size(), 0.0);
+
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        auto e0 = chrono::steady_clock::now();
+        double err = pass(shards, params, k, &grad);
+        double passSec = chrono::duration<double>(chrono::steady_clock::now() - e0).count();
+
+        for (size_t i = 0; i < params.size(); ++i) {
+            m[i] = beta1 * m[i] + (1 - beta1) * grad[i];
+            v[i] = beta2 * v[i] + (1 - beta2) * grad[i] * grad[i];
+            double mh = m[i] / (1 - pow(beta1, epoch));
+            double vh = v[i] / (1 - pow(beta2, epoch));
+            params[i] -= rate * mh / (sqrt(vh) + eps);
+        }
+
+        if (epoch % 25 == 0 || epoch == 1 || epoch == epochs) {
+            cout << "Epoch " << epoch << " error " << err << ", pass " << passSec * 1000 << " ms ("
+                 << (uint64_t)(n / max(passSec, 1e-9)) << " pos/s)" << endl;
+        }
+        if (epoch % 100 == 0 || epoch == epochs) {
+            if (!writeParams(outPath, params)) {
+                cerr << "cannot write " << outPath << "\n";
+                return 1;
+            }
+        }
+    }
+
+    cout << "Written " << outPath << " in " << seconds() << " s" << endl;
+    return 0;
+}
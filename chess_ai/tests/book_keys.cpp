@@ -0,0 +1,45 @@
+// Ключи Polyglot для позиций из спецификации формата (pg_key.c)
+#include "book.h"
+
+#include <cstdio>
+
+struct KeyCase {
+    const char* fen;
+    uint64_t key;
+};
+
+static const KeyCase CASES[] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",          0x463B96181691FC9CULL },
+    { "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",       0x823C9B50FD114196ULL },
+    { "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2",     0x0756B94461C50FB0ULL },
+    { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2",       0x662FAFB965DB29D4ULL },
+    { "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",     0x22A48B5A8E47FF78ULL },
+    { "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3",        0x652A607CA3F242C1ULL },
+    { "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4",         0x00FDD303C946BDD9ULL },
+    { "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3",     0x3C8123EA7B067637ULL },
+    { "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4",      0x5C3F9B829B279560ULL },
+};
+
+int main() {
+    int failed = 0;
+    for (const auto& c : CASES) {
+        Board b;
+        if (!b.setFromFEN(c.fen)) {
+            std::printf("bad fen: %s\n", c.fen);
+            ++failed;
+            continue;
+        }
+        uint64_t k = PolyglotBook::key(b);
+        if (k != c.key) {
+            std::printf("%s\n  got %016llx, want %016llx\n", c.fen,
+                        (unsigned long long)k, (unsigned long long)c.key);
+            ++failed;
+        }
+    }
+    if (!PolyglotBook::randomOk()) {
+        std::printf("randomOk() == false\n");
+        ++failed;
+    }
+    std::printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}